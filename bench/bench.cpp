@@ -0,0 +1,238 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "alloc_track.h"
+#include "batch.h"
+#include "occlusion.h"
+#include "scenes.h"
+#include "stats.h"
+#include "trace.h"
+
+/* headless benchmark: drives each stress scene with scripted input and times
+** UI build, command traversal and vertex generation separately. results are
+** written as JSON */
+
+enum { STAGE_BUILD, STAGE_TRAVERSE, STAGE_VERTEX, STAGE_MAX };
+static const char* stage_names[] = { "ui_build", "traverse", "vertex_gen" };
+
+static long quads_flushed;
+
+
+/* the null backend: vertices are generated but nothing is uploaded */
+static void null_flush(Batch* b) {
+  quads_flushed += b->count;
+}
+
+static void null_clip(Batch* b, mu_Rect rect) {
+}
+
+
+static double now_us() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+struct SceneResult {
+  const Scene* scene;
+  std::vector<double> samples[STAGE_MAX];
+  int commands;
+  long quads;
+  /* dropped by oc_cull() with --cull, per frame */
+  int culled_commands;
+  long culled_quads;
+  /* in UI build and vertex generation after warm-up; MU_ALLOC_TRACK builds */
+  long long allocations;
+};
+
+
+static void run_scene(const Scene* scene, Batch* batch, int frames, int warmup, bool cull, SceneResult* res) {
+  mu_Context* ctx = new mu_Context;
+  scene_context_init(ctx);
+
+  res->scene = scene;
+  res->culled_commands = 0;
+  res->culled_quads = 0;
+  for (auto& s : res->samples) { s.clear(); s.reserve(frames); }
+
+  unsigned checksum = 0;
+  at_Frame allocs;
+  for (int f = 0; f < warmup + frames; f++) {
+    if (f == warmup) { at_frame(&allocs); }
+    double t0 = now_us();
+    scene_input(ctx, f);
+    {
+      ALLOC_SCOPE(AT_UI);
+      scene->frame(ctx);
+      if (cull) {
+        oc_Stats culled = oc_cull(ctx);
+        res->culled_commands = culled.commands;
+        res->culled_quads = culled.quads;
+      }
+    }
+
+    double t1 = now_us();
+    int commands = 0;
+    mu_Command* cmd = NULL;
+    while (mu_next_command(ctx, &cmd)) {
+      checksum += cmd->type;
+      commands++;
+    }
+
+    double t2 = now_us();
+    quads_flushed = 0;
+    {
+      ALLOC_SCOPE(AT_RENDER);
+      batch_draw_commands(batch, ctx);
+      batch_flush(batch);
+    }
+    double t3 = now_us();
+
+    if (f < warmup) { continue; }
+    res->samples[STAGE_BUILD].push_back(t1 - t0);
+    res->samples[STAGE_TRAVERSE].push_back(t2 - t1);
+    res->samples[STAGE_VERTEX].push_back(t3 - t2);
+    res->commands = commands;
+    res->quads = quads_flushed;
+  }
+  at_frame(&allocs);
+  res->allocations = at_total(&allocs, 1);
+  /* keeps the traversal loop from being optimized away */
+  if (checksum == 0xffffffff) { fprintf(stderr, "checksum %u\n", checksum); }
+  delete ctx;
+}
+
+
+static void write_json(FILE* fp, const std::vector<SceneResult>& results, int frames, int warmup, int workers) {
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"benchmark\": \"microui-bench\",\n");
+  fprintf(fp, "  \"microui_version\": \"%s\",\n", MU_VERSION);
+  fprintf(fp, "  \"frames\": %d,\n  \"warmup\": %d,\n  \"workers\": %d,\n", frames, warmup, workers);
+  fprintf(fp, "  \"scenes\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const SceneResult& r = results[i];
+    fprintf(fp, "    {\n      \"name\": \"%s\",\n", r.scene->name);
+    fprintf(fp, "      \"commands\": %d,\n      \"quads\": %ld,\n", r.commands, r.quads);
+    fprintf(fp, "      \"culled_commands\": %d,\n      \"culled_quads\": %ld,\n", r.culled_commands, r.culled_quads);
+    fprintf(fp, "      \"allocations\": %lld,\n", r.allocations);
+    fprintf(fp, "      \"stages\": {\n");
+    for (int s = 0; s < STAGE_MAX; s++) {
+      fprintf(fp, "        \"%s\": { \"median_us\": %.3f, \"p99_us\": %.3f, \"samples_us\": [", stage_names[s],
+        percentile(r.samples[s], 50.0), percentile(r.samples[s], 99.0));
+      for (size_t k = 0; k < r.samples[s].size(); k++) {
+        fprintf(fp, "%s%.3f", k ? ", " : "", r.samples[s][k]);
+      }
+      fprintf(fp, "] }%s\n", s + 1 < STAGE_MAX ? "," : "");
+    }
+    fprintf(fp, "      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-bench [options]\n"
+    "  --frames N     timed frames per scene (default 300)\n"
+    "  --warmup N     untimed frames per scene (default 30)\n"
+    "  --scene NAME   run one scene (repeatable); default is all\n"
+    "  --workers N    threads for vertex generation (default 0)\n"
+    "  --out FILE     write JSON to FILE instead of stdout\n"
+    "  --trace FILE   write profiling zones as Chrome trace JSON (MU_TRACE builds)\n"
+    "  --alloc-check  fail if a scene allocates after warm-up (MU_ALLOC_TRACK builds)\n"
+    "  --cull         run oc_cull() after each frame, timed as part of ui_build\n"
+    "scenes:");
+  for (int i = 0; i < scene_count; i++) { fprintf(stderr, " %s", scenes[i].name); }
+  fprintf(stderr, "\n");
+}
+
+
+int main(int argc, char** argv) {
+  int frames = 300, warmup = 30, workers = 0;
+  const char* out = NULL;
+  const char* trace = NULL;
+  bool alloc_check = false;
+  bool cull = false;
+  std::vector<const Scene*> selected;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--frames" && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else if (arg == "--warmup" && i + 1 < argc) {
+      warmup = atoi(argv[++i]);
+    } else if (arg == "--workers" && i + 1 < argc) {
+      workers = atoi(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      out = argv[++i];
+    } else if (arg == "--trace" && i + 1 < argc) {
+      trace = argv[++i];
+    } else if (arg == "--alloc-check") {
+      alloc_check = true;
+    } else if (arg == "--cull") {
+      cull = true;
+    } else if (arg == "--scene" && i + 1 < argc) {
+      const Scene* scene = find_scene(argv[++i]);
+      if (!scene) {
+        fprintf(stderr, "unknown scene '%s'\n", argv[i]);
+        usage();
+        return EXIT_FAILURE;
+      }
+      selected.push_back(scene);
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (frames < 1) { frames = 1; }
+  if (selected.empty()) {
+    for (int i = 0; i < scene_count; i++) { selected.push_back(&scenes[i]); }
+  }
+
+  batch_set_workers(workers);
+  if (trace) {
+#ifndef MU_TRACE
+    fprintf(stderr, "--trace needs a build with MU_TRACE defined (TRACE=1 ./build.sh)\n");
+#endif
+    trace_set_enabled(1);
+  }
+#ifndef MU_ALLOC_TRACK
+  if (alloc_check) {
+    fprintf(stderr, "--alloc-check needs a build with MU_ALLOC_TRACK defined (ALLOC=1 ./build.sh)\n");
+    return EXIT_FAILURE;
+  }
+#endif
+  Batch* batch = new Batch;
+  batch_init(batch, null_flush, null_clip, NULL);
+
+  std::vector<SceneResult> results(selected.size());
+  for (size_t i = 0; i < selected.size(); i++) {
+    fprintf(stderr, "running %s...\n", selected[i]->name);
+    run_scene(selected[i], batch, frames, warmup, cull, &results[i]);
+  }
+
+  FILE* fp = out ? fopen(out, "w") : stdout;
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", out);
+    return EXIT_FAILURE;
+  }
+  write_json(fp, results, frames, warmup, workers);
+  if (out) { fclose(fp); }
+  if (trace) { trace_dump(trace); }
+
+  int result = EXIT_SUCCESS;
+  for (const SceneResult& r : results) {
+    if (alloc_check && r.allocations) {
+      fprintf(stderr, "%s: %lld allocations after warm-up\n", r.scene->name, r.allocations);
+      result = EXIT_FAILURE;
+    }
+  }
+
+  delete batch;
+  batch_set_workers(0);
+  return result;
+}
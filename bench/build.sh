@@ -0,0 +1,24 @@
+#!/bin/bash
+# builds the headless benchmarks (no GLFW or GL needed); run from this directory
+
+CFLAGS="-I../src -I../externals/microui/src -Wall -O2 -g"
+# TRACE=1 ./build.sh compiles the profiling zones in
+if [ -n "$TRACE" ]; then CFLAGS="$CFLAGS -DMU_TRACE"; fi
+# ALLOC=1 ./build.sh counts allocations (--alloc-check)
+if [ -n "$ALLOC" ]; then CFLAGS="$CFLAGS -DMU_ALLOC_TRACK"; fi
+# LAYOUTCACHE=1 ./build.sh replays unchanged layouts (MU_LAYOUT_CACHE)
+if [ -n "$LAYOUTCACHE" ]; then CFLAGS="$CFLAGS -DMU_LAYOUT_CACHE"; fi
+# MEMO=1 ./build.sh compiles in memoized windows (MU_MEMO_WINDOWS)
+if [ -n "$MEMO" ]; then CFLAGS="$CFLAGS -DMU_MEMO_WINDOWS"; fi
+
+gcc -std=c11 -c ../externals/microui/src/microui.c -o microui.o $CFLAGS || exit 1
+
+COMMON="scenes.cpp stats.cpp ../src/alloc_track.cpp ../src/batch.cpp ../src/cmdlist.cpp ../src/capture.cpp ../src/demo.cpp ../src/input_record.cpp ../src/occlusion.cpp ../src/perf_stats.cpp ../src/thread_pool.cpp ../src/trace.cpp microui.o -lpthread"
+
+g++ -std=c++20 $CFLAGS -o microui-bench bench.cpp $COMMON || exit 1
+g++ -std=c++20 $CFLAGS -o microui-microbench microbench.cpp $COMMON || exit 1
+g++ -std=c++20 $CFLAGS -o microui-bench-compare compare.cpp stats.cpp || exit 1
+g++ -std=c++20 $CFLAGS -o microui-replay replay.cpp $COMMON || exit 1
+g++ -std=c++20 $CFLAGS -o microui-cmdreplay cmdreplay.cpp $COMMON || exit 1
+g++ -std=c++20 $CFLAGS -o microui-ctxbench ctxbench.cpp $COMMON || exit 1
+g++ -std=c++20 $CFLAGS -o microui-shardbench shardbench.cpp $COMMON
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "batch.h"
+#include "capture.h"
+#include "stats.h"
+
+/* renderer-only replay of a `--capture` file: translates every captured
+** frame into vertices with the null backend as fast as possible, so batch
+** changes can be measured on real traces without running any UI code */
+
+static long quads_flushed, flushes;
+
+
+static void null_flush(Batch* b) {
+  quads_flushed += b->count;
+  flushes++;
+}
+
+static void null_clip(Batch* b, mu_Rect rect) {
+}
+
+
+static double now_us() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-cmdreplay [options] CAPTURE\n"
+    "  --repeat N     replay the capture N times (default 1)\n"
+    "  --workers N    threads for vertex generation (default 0)\n");
+}
+
+
+int main(int argc, char** argv) {
+  int repeat = 1, workers = 0;
+  const char* path = NULL;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else if (arg == "--workers" && i + 1 < argc) {
+      workers = atoi(argv[++i]);
+    } else if (!path && arg[0] != '-') {
+      path = argv[i];
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (!path) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  cap_Reader* reader = cap_reader_open(path);
+  if (!reader) { return EXIT_FAILURE; }
+  const int frames = cap_reader_frame_count(reader);
+
+  batch_set_workers(workers);
+  Batch* batch = new Batch;
+  batch_init(batch, null_flush, null_clip, NULL);
+
+  std::vector<double> samples;
+  samples.reserve(static_cast<size_t>(frames) * mu_max(repeat, 1));
+  double start = now_us();
+  for (int r = 0; r < repeat; r++) {
+    for (int i = 0; i < frames; i++) {
+      const char* data;
+      int size;
+      mu_Color clear;
+      cap_reader_frame(reader, i, &data, &size, &clear);
+      double t0 = now_us();
+      batch_draw_command_list(batch, data, size);
+      batch_flush(batch);
+      samples.push_back(now_us() - t0);
+    }
+  }
+  double elapsed = now_us() - start;
+
+  printf("%s: %d frames x %d\n", path, frames, repeat);
+  printf("vertex_gen  median %8.2f us  p99 %8.2f us  max %8.2f us\n",
+    percentile(samples, 50.0), percentile(samples, 99.0), percentile(samples, 100.0));
+  if (!samples.empty()) {
+    printf("%.0f frames/s, %.1f quads and %.1f flushes per frame\n", samples.size() * 1e6 / elapsed,
+      static_cast<double>(quads_flushed) / samples.size(), static_cast<double>(flushes) / samples.size());
+  }
+
+  delete batch;
+  batch_set_workers(0);
+  cap_reader_close(reader);
+  return EXIT_SUCCESS;
+}
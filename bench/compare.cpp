@@ -0,0 +1,278 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include "stats.h"
+
+/* regression gate: compares two JSON files written by microui-bench or
+** microui-microbench. a metric regresses when its median got slower by more
+** than the threshold (widened by the baseline's own noise) and a Mann-Whitney
+** test says the shift is significant. exits 1 on any regression */
+
+enum { EXIT_REGRESSED = 1, EXIT_ERROR = 2 };
+
+
+/* just enough JSON for the benchmark outputs */
+struct JsonValue {
+  enum { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+  double number = 0.0;
+  std::string string;
+  std::vector<JsonValue> array;
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  const JsonValue* get(const char* key) const {
+    for (auto& kv : object) {
+      if (kv.first == key) { return &kv.second; }
+    }
+    return NULL;
+  }
+};
+
+
+struct JsonParser {
+  const char* p;
+  const char* end;
+
+  void skip_ws() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) { p++; }
+  }
+
+  bool literal(const char* word) {
+    size_t n = strlen(word);
+    if (static_cast<size_t>(end - p) < n || std::string(p, n) != word) { return false; }
+    p += n;
+    return true;
+  }
+
+  bool parse_string(std::string* out) {
+    if (p == end || *p != '"') { return false; }
+    p++;
+    while (p < end && *p != '"') {
+      if (*p == '\\' && p + 1 < end) { p++; }
+      out->push_back(*p++);
+    }
+    if (p == end) { return false; }
+    p++;
+    return true;
+  }
+
+  bool parse(JsonValue* v) {
+    skip_ws();
+    if (p == end) { return false; }
+    switch (*p) {
+    case '{':
+      v->type = JsonValue::OBJECT;
+      p++;
+      skip_ws();
+      if (p < end && *p == '}') { p++; return true; }
+      for (;;) {
+        std::pair<std::string, JsonValue> kv;
+        skip_ws();
+        if (!parse_string(&kv.first)) { return false; }
+        skip_ws();
+        if (p == end || *p++ != ':') { return false; }
+        if (!parse(&kv.second)) { return false; }
+        v->object.push_back(std::move(kv));
+        skip_ws();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == '}') { p++; return true; }
+        return false;
+      }
+    case '[':
+      v->type = JsonValue::ARRAY;
+      p++;
+      skip_ws();
+      if (p < end && *p == ']') { p++; return true; }
+      for (;;) {
+        v->array.emplace_back();
+        if (!parse(&v->array.back())) { return false; }
+        skip_ws();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == ']') { p++; return true; }
+        return false;
+      }
+    case '"':
+      v->type = JsonValue::STRING;
+      return parse_string(&v->string);
+    case 't': v->type = JsonValue::BOOL; v->number = 1.0; return literal("true");
+    case 'f': v->type = JsonValue::BOOL; return literal("false");
+    case 'n': return literal("null");
+    default: {
+      char* num_end;
+      v->type = JsonValue::NUMBER;
+      v->number = strtod(p, &num_end);
+      if (num_end == p) { return false; }
+      p = num_end;
+      return true;
+    }
+    }
+  }
+};
+
+
+static bool load_json(const char* path, JsonValue* root) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return false;
+  }
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) { text.append(buf, n); }
+  fclose(fp);
+
+  JsonParser parser = { text.data(), text.data() + text.size() };
+  if (!parser.parse(root) || root->type != JsonValue::OBJECT) {
+    fprintf(stderr, "'%s' is not valid JSON\n", path);
+    return false;
+  }
+  return true;
+}
+
+
+static std::vector<double> numbers(const JsonValue* v) {
+  std::vector<double> res;
+  if (!v) { return res; }
+  for (const JsonValue& e : v->array) { res.push_back(e.number); }
+  return res;
+}
+
+
+/* flattens either output format into metric name -> raw samples */
+static bool collect_metrics(const JsonValue& root, std::map<std::string, std::vector<double>>* metrics, std::string* unit) {
+  if (const JsonValue* scenes = root.get("scenes")) {
+    *unit = "us";
+    for (const JsonValue& scene : scenes->array) {
+      const JsonValue* name = scene.get("name");
+      const JsonValue* stages = scene.get("stages");
+      if (!name || !stages) { continue; }
+      for (auto& kv : stages->object) {
+        (*metrics)[name->string + "/" + kv.first] = numbers(kv.second.get("samples_us"));
+      }
+    }
+    return true;
+  }
+  if (const JsonValue* results = root.get("results")) {
+    *unit = "ns";
+    for (const JsonValue& r : results->array) {
+      const JsonValue* name = r.get("name");
+      if (name) { (*metrics)[name->string] = numbers(r.get("samples_ns")); }
+    }
+    return true;
+  }
+  return false;
+}
+
+
+/* interquartile range relative to the median */
+static double spread(const std::vector<double>& samples) {
+  double median = percentile(samples, 50.0);
+  if (median <= 0.0) { return 0.0; }
+  return (percentile(samples, 75.0) - percentile(samples, 25.0)) / median;
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-bench-compare [options] BASELINE.json CURRENT.json\n"
+    "  --threshold PCT  minimum slowdown of the median to flag (default 5)\n"
+    "  --noise K        widen the threshold to K times the baseline's\n"
+    "                   interquartile spread when that is larger (default 2)\n"
+    "  --alpha P        significance level of the Mann-Whitney test (default 0.01)\n"
+    "exits 0 when nothing regressed, 1 on a regression, 2 on bad input or when\n"
+    "a baseline metric is missing or has too few samples\n");
+}
+
+
+int main(int argc, char** argv) {
+  double threshold = 5.0, noise = 2.0, alpha = 0.01;
+  std::vector<const char*> files;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--threshold" && i + 1 < argc) {
+      threshold = atof(argv[++i]);
+    } else if (arg == "--noise" && i + 1 < argc) {
+      noise = atof(argv[++i]);
+    } else if (arg == "--alpha" && i + 1 < argc) {
+      alpha = atof(argv[++i]);
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      usage();
+      return EXIT_ERROR;
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  if (files.size() != 2) {
+    usage();
+    return EXIT_ERROR;
+  }
+
+  JsonValue base_json, cur_json;
+  if (!load_json(files[0], &base_json) || !load_json(files[1], &cur_json)) { return EXIT_ERROR; }
+
+  std::map<std::string, std::vector<double>> base, cur;
+  std::string base_unit, cur_unit;
+  if (!collect_metrics(base_json, &base, &base_unit) || !collect_metrics(cur_json, &cur, &cur_unit)) {
+    fprintf(stderr, "unrecognized benchmark output\n");
+    return EXIT_ERROR;
+  }
+  if (base_unit != cur_unit) {
+    fprintf(stderr, "the two files come from different benchmarks\n");
+    return EXIT_ERROR;
+  }
+
+  int regressions = 0, improvements = 0, compared = 0, unusable = 0;
+  printf("%-32s %12s %12s %8s %8s %9s  %s\n", "metric", ("base " + base_unit).c_str(),
+    ("cur " + cur_unit).c_str(), "change", "limit", "p", "verdict");
+  for (auto& kv : base) {
+    const std::string& name = kv.first;
+    auto it = cur.find(name);
+    if (it == cur.end()) {
+      printf("%-32s MISSING from current run\n", name.c_str());
+      unusable++;
+      continue;
+    }
+    const std::vector<double>& a = kv.second;
+    const std::vector<double>& b = it->second;
+    if (a.size() < 2 || b.size() < 2) {
+      printf("%-32s NOT ENOUGH SAMPLES (re-run the benchmark to record them)\n", name.c_str());
+      unusable++;
+      continue;
+    }
+
+    double base_median = percentile(a, 50.0);
+    double cur_median = percentile(b, 50.0);
+    double change = base_median > 0.0 ? (cur_median - base_median) / base_median * 100.0 : 0.0;
+    double limit = std::fmax(threshold, noise * spread(a) * 100.0);
+    double p = mann_whitney(a, b);
+
+    const char* verdict = "ok";
+    if (p < alpha && change > limit) {
+      verdict = "REGRESSED";
+      regressions++;
+    } else if (p < alpha && -change > limit) {
+      verdict = "improved";
+      improvements++;
+    }
+    compared++;
+    printf("%-32s %12.3f %12.3f %+7.1f%% %7.1f%% %9.2g  %s\n", name.c_str(), base_median, cur_median,
+      change, limit, p, verdict);
+  }
+  for (auto& kv : cur) {
+    if (!base.count(kv.first)) { printf("%-32s new in current run\n", kv.first.c_str()); }
+  }
+
+  printf("\n%d metrics compared, %d regressed, %d improved, %d could not be compared\n",
+    compared, regressions, improvements, unusable);
+  /* missing data fails the gate rather than passing it silently */
+  if (regressions) { return EXIT_REGRESSED; }
+  if (unusable || compared == 0) {
+    fprintf(stderr, compared ? "some baseline metrics could not be compared\n" : "no metrics could be compared\n");
+    return EXIT_ERROR;
+  }
+  return EXIT_SUCCESS;
+}
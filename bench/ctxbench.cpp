@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "demo.h"
+#include "scenes.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+/* multi-context scaling: builds one frame in each of N independent
+** contexts per iteration, spread over 1, 2, 4 .. T threads, and reports
+** contexts built per second and the speedup over one thread */
+
+struct Slot {
+  mu_Context* ctx;
+  DemoState* demo;
+  int frame;
+};
+
+struct Run {
+  std::vector<Slot> slots;
+  const Scene* scene;
+};
+
+
+static double now_us() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void build_slot(void* user, int index) {
+  Run* run = static_cast<Run*>(user);
+  Slot& s = run->slots[index];
+  scene_input(s.ctx, s.frame++);
+  /* the demo scene's process_frame() shares one state; give each context
+  ** its own instead */
+  if (s.demo) { demo_frame(s.ctx, s.demo); }
+  else { run->scene->frame(s.ctx); }
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-ctxbench [options]\n"
+    "  --contexts N   independent contexts built per iteration (default 16)\n"
+    "  --threads N    largest thread count tried (default: one per core)\n"
+    "  --frames N     timed iterations per thread count (default 100)\n"
+    "  --scene NAME   scene each context builds (default windows_32)\n"
+    "scenes:");
+  for (int i = 0; i < scene_count; i++) { fprintf(stderr, " %s", scenes[i].name); }
+  fprintf(stderr, "\n");
+}
+
+
+int main(int argc, char** argv) {
+  int contexts = 16, frames = 100;
+  int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+  const Scene* scene = find_scene("windows_32");
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--contexts" && i + 1 < argc) {
+      contexts = atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      max_threads = atoi(argv[++i]);
+    } else if (arg == "--frames" && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else if (arg == "--scene" && i + 1 < argc) {
+      scene = find_scene(argv[++i]);
+      if (!scene) {
+        fprintf(stderr, "unknown scene '%s'\n", argv[i]);
+        usage();
+        return EXIT_FAILURE;
+      }
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  contexts = mu_max(contexts, 1);
+  frames = mu_max(frames, 1);
+  max_threads = mu_max(max_threads, 1);
+
+  Run run;
+  run.scene = scene;
+  const bool demo = scene->frame == process_frame;
+  for (int i = 0; i < contexts; i++) {
+    Slot s = { new mu_Context, demo ? new DemoState : NULL, 0 };
+    scene_context_init(s.ctx);
+    if (s.demo) { demo_init(s.demo); }
+    run.slots.push_back(s);
+  }
+
+  printf("%s, %d contexts\n", scene->name, contexts);
+  printf("%7s %14s %14s %10s\n", "threads", "median us/it", "contexts/s", "speedup");
+  double single = 0.0;
+  for (int threads = 1;; threads = mu_min(threads * 2, max_threads)) {
+    tp_Pool* pool = threads > 1 ? tp_create(threads - 1) : NULL;
+    std::vector<double> samples;
+    for (int f = -frames / 10; f < frames; f++) {
+      double t0 = now_us();
+      if (pool) { tp_run(pool, contexts, build_slot, &run); }
+      else { for (int i = 0; i < contexts; i++) { build_slot(&run, i); } }
+      if (f >= 0) { samples.push_back(now_us() - t0); }
+    }
+    tp_destroy(pool);
+
+    double median = percentile(samples, 50.0);
+    if (threads == 1) { single = median; }
+    printf("%7d %14.1f %14.0f %9.2fx\n", threads, median, contexts * 1e6 / median, single / median);
+    if (threads == max_threads) { break; }
+  }
+
+  for (Slot& s : run.slots) {
+    delete s.ctx;
+    delete s.demo;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,316 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+extern "C" {
+#include "microui.h"
+}
+#include "batch.h"
+#include "scenes.h"
+#include "stats.h"
+
+/* focused microbenchmarks for the hot primitives. each benchmark is
+** calibrated until one sample takes SAMPLE_TARGET_NS, warmed up, then
+** sampled SAMPLES times; a run whose interquartile spread exceeds
+** MAX_SPREAD of the median is repeated up to MAX_ATTEMPTS times */
+
+#define SAMPLE_TARGET_NS 5e6
+#define WARMUP_SAMPLES   3
+#define SAMPLES          21
+#define MAX_SPREAD       0.05
+#define MAX_ATTEMPTS     3
+
+typedef struct {
+  const char* name;
+  /* untimed setup and teardown around every sample */
+  void (*setup)(mu_Context* ctx);
+  void (*teardown)(mu_Context* ctx);
+  /* runs `iters` operations */
+  void (*run)(mu_Context* ctx, long iters);
+} MicroBench;
+
+static mu_Context* ctx;
+static Batch* batch;
+static volatile unsigned sink;
+
+
+static void null_flush(Batch* b) {
+}
+
+static void null_clip(Batch* b, mu_Rect rect) {
+}
+
+
+static void begin_window(mu_Context* ctx) {
+  mu_begin(ctx);
+  mu_begin_window(ctx, "Bench", mu_rect(0, 0, SCENE_WIDTH, SCENE_HEIGHT));
+}
+
+static void end_window(mu_Context* ctx) {
+  mu_end_window(ctx);
+  mu_end(ctx);
+}
+
+static void no_op(mu_Context* ctx) {
+}
+
+
+static void layout_next_setup(mu_Context* ctx) {
+  begin_window(ctx);
+  const int widths[] = { 100, 100, 100, -1 };
+  mu_layout_row(ctx, 4, widths, 0);
+}
+
+static void layout_next_run(mu_Context* ctx, long iters) {
+  unsigned acc = 0;
+  for (long i = 0; i < iters; i++) {
+    /* restart the row before the positions can overflow */
+    if ((i & 0xfffff) == 0) {
+      const int widths[] = { 100, 100, 100, -1 };
+      mu_layout_row(ctx, 4, widths, 0);
+    }
+    acc += mu_layout_next(ctx).y;
+  }
+  sink = acc;
+}
+
+
+static void get_id_run(mu_Context* ctx, long iters) {
+  unsigned acc = 0;
+  for (long i = 0; i < iters; i++) {
+    acc += mu_get_id(ctx, "Button 1234", 11);
+  }
+  sink = acc;
+}
+
+
+static void clip_setup(mu_Context* ctx) {
+  begin_window(ctx);
+  mu_push_clip_rect(ctx, mu_rect(100, 100, 800, 600));
+}
+
+static void clip_teardown(mu_Context* ctx) {
+  mu_pop_clip_rect(ctx);
+  end_window(ctx);
+}
+
+static void check_clip_run(mu_Context* ctx, long iters) {
+  unsigned acc = 0;
+  for (long i = 0; i < iters; i++) {
+    /* sweep across inside, partial and outside cases */
+    acc += mu_check_clip(ctx, mu_rect(static_cast<int>(i & 1023), 300, 80, 20));
+  }
+  sink = acc;
+}
+
+static void push_clip_rect_run(mu_Context* ctx, long iters) {
+  /* intersect_rects() is static; mu_push_clip_rect() is its thinnest caller */
+  for (long i = 0; i < iters; i++) {
+    mu_push_clip_rect(ctx, mu_rect(static_cast<int>(i & 1023), 300, 80, 20));
+    mu_pop_clip_rect(ctx);
+  }
+}
+
+
+static void push_command_run(mu_Context* ctx, long iters) {
+  for (long i = 0; i < iters; i++) {
+    if (ctx->command_list.idx > MU_COMMANDLIST_SIZE - 256) { ctx->command_list.idx = 0; }
+    mu_push_command(ctx, MU_COMMAND_RECT, sizeof(mu_RectCommand));
+  }
+}
+
+
+static void next_command_setup(mu_Context* ctx) {
+  /* 32 root windows give a jump-heavy list */
+  find_scene("windows_32")->frame(ctx);
+}
+
+static void next_command_run(mu_Context* ctx, long iters) {
+  unsigned acc = 0;
+  mu_Command* cmd = NULL;
+  for (long i = 0; i < iters; i++) {
+    if (!mu_next_command(ctx, &cmd)) { cmd = NULL; continue; }
+    acc += cmd->type;
+  }
+  sink = acc;
+}
+
+
+static void push_quad_run(mu_Context* ctx, long iters) {
+  mu_Color color = mu_color(200, 100, 50, 255);
+  mu_Rect src = mu_rect(125, 68, 3, 3);
+  for (long i = 0; i < iters; i++) {
+    batch_push_quad(batch, mu_rect(static_cast<int>(i & 1023), 40, 80, 20), src, color);
+  }
+  batch_flush(batch);
+}
+
+
+static void text_width_run(mu_Context* ctx, long iters) {
+  unsigned acc = 0;
+  for (long i = 0; i < iters; i++) {
+    acc += batch_text_width("Lorem ipsum dolor", 17);
+  }
+  sink = acc;
+}
+
+
+static const MicroBench benches[] = {
+  { "mu_layout_next",     layout_next_setup,  end_window,    layout_next_run    },
+  { "mu_get_id",          begin_window,       end_window,    get_id_run         },
+  { "mu_check_clip",      clip_setup,         clip_teardown, check_clip_run     },
+  { "mu_push_clip_rect",  clip_setup,         clip_teardown, push_clip_rect_run },
+  { "mu_push_command",    begin_window,       end_window,    push_command_run   },
+  { "mu_next_command",    next_command_setup, no_op,         next_command_run   },
+  { "push_quad",          no_op,              no_op,         push_quad_run      },
+  { "r_get_text_width",   no_op,              no_op,         text_width_run     },
+};
+
+
+static double sample_ns(const MicroBench& b, long iters) {
+  using namespace std::chrono;
+  b.setup(ctx);
+  auto t0 = steady_clock::now();
+  b.run(ctx, iters);
+  auto t1 = steady_clock::now();
+  b.teardown(ctx);
+  return static_cast<double>(duration_cast<nanoseconds>(t1 - t0).count());
+}
+
+
+struct MicroResult {
+  const char* name;
+  double ns_per_op;
+  double spread;
+  long iters;
+  int attempts;
+  bool stable;
+  std::vector<double> samples;
+};
+
+
+static MicroResult run_bench(const MicroBench& b) {
+  MicroResult res = { b.name, 0.0, 0.0, 1, 0, false, {} };
+
+  /* calibrate */
+  while (sample_ns(b, res.iters) < SAMPLE_TARGET_NS && res.iters < (1L << 40)) {
+    res.iters *= 2;
+  }
+
+  for (res.attempts = 1; res.attempts <= MAX_ATTEMPTS; res.attempts++) {
+    for (int i = 0; i < WARMUP_SAMPLES; i++) { sample_ns(b, res.iters); }
+    std::vector<double> per_op;
+    for (int i = 0; i < SAMPLES; i++) {
+      per_op.push_back(sample_ns(b, res.iters) / res.iters);
+    }
+    res.ns_per_op = percentile(per_op, 50.0);
+    res.spread = (percentile(per_op, 75.0) - percentile(per_op, 25.0)) / res.ns_per_op;
+    res.stable = res.spread <= MAX_SPREAD;
+    res.samples = per_op;
+    if (res.stable) { break; }
+  }
+  if (res.attempts > MAX_ATTEMPTS) { res.attempts = MAX_ATTEMPTS; }
+  return res;
+}
+
+
+static bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-microbench [options]\n"
+    "  --cpu N        pin to CPU N (default 0, -1 to disable)\n"
+    "  --only NAME    run one benchmark (repeatable)\n"
+    "  --out FILE     write JSON to FILE instead of stdout\n"
+    "benchmarks:");
+  for (const MicroBench& b : benches) { fprintf(stderr, " %s", b.name); }
+  fprintf(stderr, "\n");
+}
+
+
+int main(int argc, char** argv) {
+  int cpu = 0;
+  const char* out = NULL;
+  std::vector<const MicroBench*> selected;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--cpu" && i + 1 < argc) {
+      cpu = atoi(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      out = argv[++i];
+    } else if (arg == "--only" && i + 1 < argc) {
+      std::string name = argv[++i];
+      for (const MicroBench& b : benches) {
+        if (name == b.name) { selected.push_back(&b); }
+      }
+      if (selected.empty() || selected.back()->name != name) {
+        fprintf(stderr, "unknown benchmark '%s'\n", name.c_str());
+        usage();
+        return EXIT_FAILURE;
+      }
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (selected.empty()) {
+    for (const MicroBench& b : benches) { selected.push_back(&b); }
+  }
+
+  bool pinned = cpu >= 0 && pin_to_cpu(cpu);
+  if (cpu >= 0 && !pinned) { fprintf(stderr, "warning: could not pin to cpu %d\n", cpu); }
+
+  ctx = new mu_Context;
+  scene_context_init(ctx);
+  batch = new Batch;
+  batch_init(batch, null_flush, null_clip, NULL);
+
+  std::vector<MicroResult> results;
+  for (const MicroBench* b : selected) {
+    MicroResult r = run_bench(*b);
+    fprintf(stderr, "%-20s %10.2f ns/op %14.0f ops/s  spread %5.1f%%%s\n", r.name, r.ns_per_op,
+      1e9 / r.ns_per_op, r.spread * 100.0, r.stable ? "" : "  UNSTABLE");
+    results.push_back(r);
+  }
+
+  FILE* fp = out ? fopen(out, "w") : stdout;
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", out);
+    return EXIT_FAILURE;
+  }
+  fprintf(fp, "{\n  \"benchmark\": \"microui-microbench\",\n");
+  fprintf(fp, "  \"microui_version\": \"%s\",\n", MU_VERSION);
+  fprintf(fp, "  \"pinned_cpu\": %d,\n", pinned ? cpu : -1);
+  fprintf(fp, "  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const MicroResult& r = results[i];
+    fprintf(fp, "    { \"name\": \"%s\", \"ns_per_op\": %.4f, \"ops_per_s\": %.0f, "
+      "\"iters\": %ld, \"spread\": %.4f, \"attempts\": %d, \"stable\": %s, \"samples_ns\": [",
+      r.name, r.ns_per_op, 1e9 / r.ns_per_op, r.iters, r.spread, r.attempts, r.stable ? "true" : "false");
+    for (size_t k = 0; k < r.samples.size(); k++) {
+      fprintf(fp, "%s%.4f", k ? ", " : "", r.samples[k]);
+    }
+    fprintf(fp, "] }%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+  if (out) { fclose(fp); }
+
+  delete batch;
+  delete ctx;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "batch.h"
+#include "capture.h"
+#include "demo.h"
+#include "input_record.h"
+#include "scenes.h"
+#include "stats.h"
+
+/* headless replay of a session recorded with `--record`: feeds the same
+** input to process_frame() frame by frame and times UI build and vertex
+** generation, so a slow frame seen live can be reproduced and profiled */
+
+static void null_flush(Batch* b) {
+}
+
+static void null_clip(Batch* b, mu_Rect rect) {
+}
+
+
+static double now_us() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+struct FrameTime {
+  int frame;
+  double build, vertex;
+};
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-replay [options] RECORDING\n"
+    "  --repeat N     replay the recording N times (default 1)\n"
+    "  --slowest N    list the N slowest frames (default 5)\n"
+    "  --workers N    threads for vertex generation (default 0)\n"
+    "  --capture FILE also write the first pass's command lists, for\n"
+    "                 microui-cmdreplay\n");
+}
+
+
+int main(int argc, char** argv) {
+  int repeat = 1, slowest = 5, workers = 0;
+  const char* path = NULL;
+  const char* capture = NULL;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else if (arg == "--slowest" && i + 1 < argc) {
+      slowest = atoi(argv[++i]);
+    } else if (arg == "--workers" && i + 1 < argc) {
+      workers = atoi(argv[++i]);
+    } else if (arg == "--capture" && i + 1 < argc) {
+      capture = argv[++i];
+    } else if (!path && arg[0] != '-') {
+      path = argv[i];
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (!path) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  batch_set_workers(workers);
+  Batch* batch = new Batch;
+  batch_init(batch, null_flush, null_clip, NULL);
+
+  if (capture && !cap_open(capture)) { return EXIT_FAILURE; }
+
+  std::vector<FrameTime> times;
+  for (int r = 0; r < repeat; r++) {
+    ir_Player* player = ir_player_open(path);
+    if (!player) { return EXIT_FAILURE; }
+    if (r == 0) { fprintf(stderr, "%s: %d frames\n", path, ir_player_frame_count(player)); }
+
+    /* a fresh context per pass; the demo's own state carries over, as it
+    ** would in a long-running session */
+    mu_Context* ctx = new mu_Context;
+    scene_context_init(ctx);
+    for (int f = 0; ir_player_next_frame(player, ctx); f++) {
+      double t0 = now_us();
+      process_frame(ctx);
+      double t1 = now_us();
+      batch_draw_commands(batch, ctx);
+      batch_flush(batch);
+      double t2 = now_us();
+      if (r == 0) { cap_frame(ctx, demo_background()); }
+      times.push_back({ f, t1 - t0, t2 - t1 });
+    }
+    delete ctx;
+    ir_player_close(player);
+    cap_close();
+  }
+
+  std::vector<double> build, vertex;
+  for (const FrameTime& t : times) {
+    build.push_back(t.build);
+    vertex.push_back(t.vertex);
+  }
+  printf("%zu frames replayed\n", times.size());
+  printf("ui_build    median %8.2f us  p99 %8.2f us  max %8.2f us\n",
+    percentile(build, 50.0), percentile(build, 99.0), percentile(build, 100.0));
+  printf("vertex_gen  median %8.2f us  p99 %8.2f us  max %8.2f us\n",
+    percentile(vertex, 50.0), percentile(vertex, 99.0), percentile(vertex, 100.0));
+
+  std::sort(times.begin(), times.end(), [](const FrameTime& a, const FrameTime& b) {
+    return a.build + a.vertex > b.build + b.vertex;
+  });
+  for (int i = 0; i < slowest && i < static_cast<int>(times.size()); i++) {
+    printf("slow frame %6d: ui_build %8.2f us, vertex_gen %8.2f us\n", times[i].frame, times[i].build, times[i].vertex);
+  }
+
+  delete batch;
+  batch_set_workers(0);
+  return EXIT_SUCCESS;
+}
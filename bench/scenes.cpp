@@ -0,0 +1,207 @@
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include "scenes.h"
+#include "batch.h"
+#include "demo.h"
+
+#define BUTTON_COUNT   10000
+#define BUTTON_COLUMNS 10
+#define TREE_DEPTH     12
+#define TEXT_LOG_SIZE  (1024 * 1024)
+#define WINDOW_COUNT   32
+#define DASHBOARD_WINDOWS 100
+#define INSPECTOR_SECTIONS 50
+#define INSPECTOR_ROWS     50
+
+
+static void buttons_10k(mu_Context* ctx) {
+  /* built once, thread-safely, for microui-ctxbench */
+  static const std::vector<std::string> labels = [] {
+    std::vector<std::string> res;
+    for (int i = 0; i < BUTTON_COUNT; i++) { res.push_back("Button " + std::to_string(i)); }
+    return res;
+  }();
+  mu_begin(ctx);
+  if (mu_begin_window(ctx, "Buttons", mu_rect(0, 0, SCENE_WIDTH, SCENE_HEIGHT))) {
+    int widths[BUTTON_COLUMNS];
+    for (int& w : widths) { w = (SCENE_WIDTH - 40) / BUTTON_COLUMNS - 4; }
+    mu_layout_row(ctx, BUTTON_COLUMNS, widths, 0);
+    for (const std::string& label : labels) { mu_button(ctx, label.c_str()); }
+    mu_end_window(ctx);
+  }
+  mu_end(ctx);
+}
+
+
+static void tree(mu_Context* ctx, int depth) {
+  static const char* names[] = { "Left", "Right" };
+  for (const char* name : names) {
+    if (mu_begin_treenode_ex(ctx, name, MU_OPT_EXPANDED)) {
+      mu_label(ctx, "Label");
+      mu_label(ctx, "Another label");
+      if (depth > 1) { tree(ctx, depth - 1); }
+      mu_end_treenode(ctx);
+    }
+  }
+}
+
+static void deep_treenodes(mu_Context* ctx) {
+  mu_begin(ctx);
+  if (mu_begin_window(ctx, "Tree", mu_rect(0, 0, SCENE_WIDTH, SCENE_HEIGHT))) {
+    tree(ctx, TREE_DEPTH);
+    mu_end_window(ctx);
+  }
+  mu_end(ctx);
+}
+
+
+static void text_log_1mb(mu_Context* ctx) {
+  static const std::string log = [] {
+    std::string res;
+    char line[128];
+    for (int i = 0; res.size() < TEXT_LOG_SIZE; i++) {
+      snprintf(line, sizeof(line), "%06d: lorem ipsum dolor sit amet, consectetur adipiscing elit\n", i);
+      res += line;
+    }
+    res.resize(TEXT_LOG_SIZE);
+    return res;
+  }();
+  mu_begin(ctx);
+  if (mu_begin_window(ctx, "Log", mu_rect(0, 0, SCENE_WIDTH, SCENE_HEIGHT))) {
+    const int widths[] = { -1 };
+    mu_layout_row(ctx, 1, widths, -1);
+    mu_begin_panel(ctx, "Log Output");
+    mu_layout_row(ctx, 1, widths, -1);
+    mu_text(ctx, log.c_str());
+    mu_end_panel(ctx);
+    mu_end_window(ctx);
+  }
+  mu_end(ctx);
+}
+
+
+/* sliders store their value back every frame; per-thread copies keep
+** microui-ctxbench race-free, and the scripted input never changes them */
+static void overlapping_windows(mu_Context* ctx, int count, int rows, bool memo) {
+  static thread_local float values[DASHBOARD_WINDOWS];
+  static thread_local int checks[DASHBOARD_WINDOWS];
+  mu_begin(ctx);
+  for (int i = 0; i < count; i++) {
+    char title[32];
+    snprintf(title, sizeof(title), "Window %d", i);
+    mu_Rect rect = mu_rect(40 + (i % 8) * 180, 40 + (i / 8 % 5) * 200, 360, 320);
+    /* the data never changes, so the version stays 0 */
+    if (memo ? mu_begin_window_memo(ctx, title, rect, 0, 0) : mu_begin_window(ctx, title, rect)) {
+      const int widths[] = { 100, -1 };
+      mu_layout_row(ctx, 2, widths, 0);
+      for (int j = 0; j < rows; j++) {
+        mu_label(ctx, "Value:");
+        mu_push_id(ctx, &j, sizeof(j));
+        mu_slider(ctx, &values[i], 0, 100);
+        mu_pop_id(ctx);
+      }
+      mu_checkbox(ctx, "Enabled", &checks[i]);
+      mu_button(ctx, "Apply");
+      mu_end_window(ctx);
+    }
+  }
+  mu_end(ctx);
+}
+
+static void windows_32(mu_Context* ctx) {
+  overlapping_windows(ctx, WINDOW_COUNT, 8, false);
+}
+
+/* the same windows through mu_begin_window_memo(): only the one under the
+** mouse is rebuilt. the same as windows_32 unless built with MEMO=1 */
+static void windows_32_memo(mu_Context* ctx) {
+  overlapping_windows(ctx, WINDOW_COUNT, 8, true);
+}
+
+/* a dashboard of 100 smaller windows, stacked five rows deep */
+static void windows_100(mu_Context* ctx) {
+  overlapping_windows(ctx, DASHBOARD_WINDOWS, 3, false);
+}
+
+
+/* a property inspector: 50 sections of 50 label/value rows, 5 000 widgets,
+** most of them scrolled out of view */
+static void inspector_5k(mu_Context* ctx) {
+  static thread_local float values[INSPECTOR_SECTIONS][INSPECTOR_ROWS];
+  static thread_local int flags[INSPECTOR_SECTIONS][INSPECTOR_ROWS];
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> res;
+    for (int i = 0; i < INSPECTOR_ROWS; i++) { res.push_back("property_" + std::to_string(i)); }
+    return res;
+  }();
+  mu_begin(ctx);
+  if (mu_begin_window(ctx, "Inspector", mu_rect(0, 0, 640, SCENE_HEIGHT))) {
+    const int widths[] = { 160, -1 };
+    for (int s = 0; s < INSPECTOR_SECTIONS; s++) {
+      char title[32];
+      snprintf(title, sizeof(title), "Component %d", s);
+      if (!mu_header_ex(ctx, title, MU_OPT_EXPANDED)) { continue; }
+      mu_push_id(ctx, &s, sizeof(s));
+      mu_layout_row(ctx, 2, widths, 0);
+      for (int i = 0; i < INSPECTOR_ROWS; i++) {
+        mu_label(ctx, names[i].c_str());
+        mu_push_id(ctx, &i, sizeof(i));
+        if (i % 4 == 3) { mu_checkbox(ctx, "", &flags[s][i]); }
+        else { mu_slider(ctx, &values[s][i], 0, 100); }
+        mu_pop_id(ctx);
+      }
+      mu_pop_id(ctx);
+    }
+    mu_end_window(ctx);
+  }
+  mu_end(ctx);
+}
+
+
+const Scene scenes[] = {
+  { "buttons_10k",     buttons_10k     },
+  { "deep_treenodes",  deep_treenodes  },
+  { "text_log_1mb",    text_log_1mb    },
+  { "windows_32",      windows_32      },
+  { "windows_32_memo", windows_32_memo },
+  { "windows_100",     windows_100     },
+  { "inspector_5k",    inspector_5k    },
+  { "demo",            process_frame   },
+};
+const int scene_count = sizeof(scenes) / sizeof(scenes[0]);
+
+
+const Scene* find_scene(const char* name) {
+  for (int i = 0; i < scene_count; i++) {
+    if (strcmp(scenes[i].name, name) == 0) { return &scenes[i]; }
+  }
+  return NULL;
+}
+
+
+static int text_width(mu_Font font, const char* text, int len) {
+  if (len == -1) { len = static_cast<int>(strlen(text)); }
+  return batch_text_width(text, len);
+}
+
+static int text_height(mu_Font font) {
+  return batch_text_height();
+}
+
+void scene_context_init(mu_Context* ctx) {
+  mu_init(ctx);
+  ctx->text_width = text_width;
+  ctx->text_height = text_height;
+}
+
+
+void scene_input(mu_Context* ctx, int frame) {
+  double t = frame * 0.05;
+  int x = static_cast<int>(SCENE_WIDTH  * (0.5 + 0.45 * std::sin(t * 1.3)));
+  int y = static_cast<int>(SCENE_HEIGHT * (0.5 + 0.45 * std::sin(t * 0.7)));
+  mu_input_mousemove(ctx, x, y);
+  if (frame % 8 == 0) { mu_input_scroll(ctx, 0, (frame / 8) % 2 ? -60 : 60); }
+}
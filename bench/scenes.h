@@ -0,0 +1,27 @@
+#ifndef SCENES_H
+#define SCENES_H
+extern "C" {
+#include "microui.h"
+}
+
+/* virtual screen the scenes are laid out on */
+#define SCENE_WIDTH  1920
+#define SCENE_HEIGHT 1080
+
+/* a stress scene builds one complete frame, mu_begin() to mu_end() */
+typedef struct {
+  const char* name;
+  void (*frame)(mu_Context* ctx);
+} Scene;
+
+extern const Scene scenes[];
+extern const int scene_count;
+
+const Scene* find_scene(const char* name);
+/* mu_init() plus the atlas font metrics callbacks */
+void scene_context_init(mu_Context* ctx);
+/* deterministic mouse sweep with periodic wheel scrolling; call before
+** building frame `frame` */
+void scene_input(mu_Context* ctx, int frame);
+
+#endif
@@ -0,0 +1,233 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "cmdlist.h"
+#include "scenes.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+/* parallel root windows within one context: builds a screen of heavy
+** windows serially and through shards (mu_shard_begin/mu_shard_end) on
+** 1, 2, 4 .. T threads. every sharded frame must draw exactly the commands
+** of the serial one */
+
+#define ROWS_PER_WINDOW 40
+/* the serial context's command list holds about 38 of these windows */
+#define MAX_WINDOWS     32
+
+struct WindowData {
+  float values[ROWS_PER_WINDOW];
+  int checks[ROWS_PER_WINDOW];
+};
+
+struct Screen {
+  int windows;
+  std::vector<WindowData> data;
+};
+
+struct Sharded {
+  Screen* screen;
+  mu_Context* ctx;
+  std::vector<mu_Context*> shards;
+};
+
+
+static double now_us() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void heavy_window(mu_Context* ctx, Screen* screen, int index) {
+  char title[32];
+  snprintf(title, sizeof(title), "Window %d", index);
+  mu_Rect rect = mu_rect(20 + (index % 6) * 300, 20 + (index / 6) * 250, 320, 300);
+  if (!mu_begin_window(ctx, title, rect)) { return; }
+  WindowData& d = screen->data[index];
+  const int widths[] = { 60, -90, -1 };
+  mu_layout_row(ctx, 3, widths, 0);
+  for (int i = 0; i < ROWS_PER_WINDOW; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "Item %d", i);
+    mu_label(ctx, label);
+    mu_push_id(ctx, &i, sizeof(i));
+    mu_slider(ctx, &d.values[i], 0, 100);
+    mu_checkbox(ctx, "on", &d.checks[i]);
+    mu_pop_id(ctx);
+  }
+  mu_end_window(ctx);
+}
+
+
+/* field by field: text commands carry uninitialized padding after the string */
+static bool same_command(const mu_Command* a, const mu_Command* b) {
+  if (a->type != b->type) { return false; }
+  switch (a->type) {
+  case MU_COMMAND_CLIP: return memcmp(&a->clip.rect, &b->clip.rect, sizeof(mu_Rect)) == 0;
+  case MU_COMMAND_RECT: return memcmp(&a->rect, &b->rect, sizeof(mu_RectCommand)) == 0;
+  case MU_COMMAND_ICON: return memcmp(&a->icon, &b->icon, sizeof(mu_IconCommand)) == 0;
+  case MU_COMMAND_BOX: return memcmp(&a->box, &b->box, sizeof(mu_BoxCommand)) == 0;
+  case MU_COMMAND_FRAME: return memcmp(&a->frame, &b->frame, sizeof(mu_FrameCommand)) == 0;
+  case MU_COMMAND_TEXT:
+    return a->text.pos.x == b->text.pos.x && a->text.pos.y == b->text.pos.y &&
+      memcmp(&a->text.color, &b->text.color, sizeof(mu_Color)) == 0 && strcmp(a->text.str, b->text.str) == 0;
+  }
+  return true;
+}
+
+
+static bool same_commands(const char* a, int na, const char* b, int nb) {
+  const mu_Command* ca = NULL;
+  const mu_Command* cb = NULL;
+  for (;;) {
+    int more_a = cmdlist_next(a, na, &ca);
+    int more_b = cmdlist_next(b, nb, &cb);
+    if (more_a != more_b) { return false; }
+    if (!more_a) { return true; }
+    if (!same_command(ca, cb)) { return false; }
+  }
+}
+
+
+/* a mouse sweep that clicks every 16 frames, so focus and z-order move */
+static void input(mu_Context* ctx, int frame) {
+  double t = frame * 0.05;
+  int x = static_cast<int>(SCENE_WIDTH  * (0.5 + 0.45 * std::sin(t * 1.3)));
+  int y = static_cast<int>(SCENE_HEIGHT * (0.5 + 0.45 * std::sin(t * 0.7)));
+  mu_input_mousemove(ctx, x, y);
+  if (frame % 16 == 0) { mu_input_mousedown(ctx, x, y, MU_MOUSE_LEFT); }
+  if (frame % 16 == 2) { mu_input_mouseup(ctx, x, y, MU_MOUSE_LEFT); }
+}
+
+
+static void build_serial(mu_Context* ctx, Screen* screen) {
+  mu_begin(ctx);
+  for (int i = 0; i < screen->windows; i++) { heavy_window(ctx, screen, i); }
+  mu_end(ctx);
+}
+
+
+/* shard k always builds the same contiguous run of windows */
+static void build_shard(void* user, int k) {
+  Sharded* s = static_cast<Sharded*>(user);
+  const int n = static_cast<int>(s->shards.size());
+  const int first = s->screen->windows * k / n, last = s->screen->windows * (k + 1) / n;
+  for (int i = first; i < last; i++) { heavy_window(s->shards[k], s->screen, i); }
+}
+
+
+static void build_sharded(Sharded* s, tp_Pool* pool) {
+  const int n = static_cast<int>(s->shards.size());
+  mu_begin(s->ctx);
+  for (mu_Context* shard : s->shards) { mu_shard_begin(s->ctx, shard); }
+  if (pool) { tp_run(pool, n, build_shard, s); }
+  else { for (int k = 0; k < n; k++) { build_shard(s, k); } }
+  for (mu_Context* shard : s->shards) { mu_shard_end(s->ctx, shard); }
+  mu_end(s->ctx);
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-shardbench [options]\n"
+    "  --windows N  heavy root windows on the screen (default 24)\n"
+    "  --shards N   shard contexts the windows are split over (default 8)\n"
+    "  --threads N  largest thread count tried (default: one per core)\n"
+    "  --frames N   timed frames per configuration (default 100)\n");
+}
+
+
+int main(int argc, char** argv) {
+  int windows = 24, shards = 8, frames = 100;
+  int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--windows" && i + 1 < argc) {
+      windows = atoi(argv[++i]);
+    } else if (arg == "--shards" && i + 1 < argc) {
+      shards = atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      max_threads = atoi(argv[++i]);
+    } else if (arg == "--frames" && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  windows = mu_clamp(windows, 1, MAX_WINDOWS);
+  shards = mu_clamp(shards, 1, windows);
+  frames = mu_max(frames, 1);
+  max_threads = mu_max(max_threads, 1);
+
+  /* correctness first: the same input through both paths */
+  Screen serial_screen = { windows, std::vector<WindowData>(windows) };
+  Screen sharded_screen = serial_screen;
+  mu_Context* serial = new mu_Context;
+  scene_context_init(serial);
+  Sharded s = { &sharded_screen, new mu_Context, {} };
+  scene_context_init(s.ctx);
+  for (int k = 0; k < shards; k++) {
+    s.shards.push_back(new mu_Context);
+    mu_init(s.shards.back());
+  }
+  std::vector<char> a(MU_COMMANDLIST_SIZE), b(MU_COMMANDLIST_SIZE);
+  for (int f = 0; f < 200; f++) {
+    input(serial, f);
+    input(s.ctx, f);
+    build_serial(serial, &serial_screen);
+    build_sharded(&s, NULL);
+    int na = cmdlist_linearize(serial, a.data(), MU_COMMANDLIST_SIZE);
+    int nb = cmdlist_linearize(s.ctx, b.data(), MU_COMMANDLIST_SIZE);
+    if (!same_commands(a.data(), na, b.data(), nb)) {
+      fprintf(stderr, "frame %d: sharded commands differ from the serial build\n", f);
+      return EXIT_FAILURE;
+    }
+  }
+  for (int i = 0; i < windows; i++) {
+    if (memcmp(&serial_screen.data[i], &sharded_screen.data[i], sizeof(WindowData)) != 0) {
+      fprintf(stderr, "window %d: sharded widget state differs from the serial build\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+
+  printf("%d windows, %d shards, %d bytes of commands\n", windows, shards, serial->command_list.idx);
+  printf("%-8s %7s %14s %10s\n", "build", "threads", "median us", "speedup");
+  std::vector<double> samples;
+  for (int f = 0; f < frames; f++) {
+    input(serial, f);
+    double t0 = now_us();
+    build_serial(serial, &serial_screen);
+    samples.push_back(now_us() - t0);
+  }
+  const double base = percentile(samples, 50.0);
+  printf("%-8s %7d %14.1f %9.2fx\n", "serial", 1, base, 1.0);
+
+  for (int threads = 1;; threads = mu_min(threads * 2, max_threads)) {
+    tp_Pool* pool = threads > 1 ? tp_create(threads - 1) : NULL;
+    samples.clear();
+    for (int f = 0; f < frames; f++) {
+      input(s.ctx, f);
+      double t0 = now_us();
+      build_sharded(&s, pool);
+      samples.push_back(now_us() - t0);
+    }
+    tp_destroy(pool);
+    double median = percentile(samples, 50.0);
+    printf("%-8s %7d %14.1f %9.2fx\n", "sharded", threads, median, base / median);
+    if (threads == max_threads) { break; }
+  }
+
+  delete serial;
+  delete s.ctx;
+  for (mu_Context* shard : s.shards) { delete shard; }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cmath>
+#include "stats.h"
+
+double percentile(std::vector<double> samples, double p) {
+  if (samples.empty()) { return 0.0; }
+  std::sort(samples.begin(), samples.end());
+  size_t rank = static_cast<size_t>(p / 100.0 * samples.size() + 0.999999);
+  rank = std::clamp<size_t>(rank, 1, samples.size());
+  return samples[rank - 1];
+}
+
+
+double mann_whitney(const std::vector<double>& a, const std::vector<double>& b) {
+  const size_t n1 = a.size(), n2 = b.size();
+  if (n1 == 0 || n2 == 0) { return 1.0; }
+
+  /* rank the pooled samples, averaging the ranks of ties */
+  std::vector<std::pair<double, int>> pooled;
+  pooled.reserve(n1 + n2);
+  for (double v : a) { pooled.emplace_back(v, 0); }
+  for (double v : b) { pooled.emplace_back(v, 1); }
+  std::sort(pooled.begin(), pooled.end());
+
+  const double n = static_cast<double>(n1 + n2);
+  double rank_sum_a = 0.0, ties = 0.0;
+  for (size_t i = 0; i < pooled.size();) {
+    size_t j = i;
+    while (j < pooled.size() && pooled[j].first == pooled[i].first) { j++; }
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; k++) {
+      if (pooled[k].second == 0) { rank_sum_a += rank; }
+    }
+    double t = static_cast<double>(j - i);
+    ties += t * t * t - t;
+    i = j;
+  }
+
+  double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+  double mean = n1 * n2 / 2.0;
+  double var = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)));
+  if (var <= 0.0) { return 1.0; }
+  /* continuity correction */
+  double z = (std::fabs(u - mean) - 0.5) / std::sqrt(var);
+  if (z < 0.0) { z = 0.0; }
+  return std::erfc(z / std::sqrt(2.0));
+}
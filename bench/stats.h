@@ -0,0 +1,11 @@
+#ifndef STATS_H
+#define STATS_H
+#include <vector>
+
+/* nearest-rank percentile, p in [0, 100] */
+double percentile(std::vector<double> samples, double p);
+/* two-sided Mann-Whitney U test (normal approximation with tie correction);
+** returns the p-value for "a and b come from the same distribution" */
+double mann_whitney(const std::vector<double>& a, const std::vector<double>& b);
+
+#endif
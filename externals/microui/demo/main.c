@@ -203,6 +203,18 @@ static void process_frame(mu_Context *ctx) {
 }
 
 
+static void draw_box(mu_Rect r, mu_Color color) {
+  if (r.w > 2) {
+    r_draw_rect(mu_rect(r.x + 1, r.y, r.w - 2, 1), color);
+    r_draw_rect(mu_rect(r.x + 1, r.y + r.h - 1, r.w - 2, 1), color);
+  }
+  if (r.h > 0) {
+    r_draw_rect(mu_rect(r.x, r.y, 1, r.h), color);
+    r_draw_rect(mu_rect(r.x + r.w - 1, r.y, 1, r.h), color);
+  }
+}
+
+
 
 static const char button_map[256] = {
   [ SDL_BUTTON_LEFT   & 0xff ] =  MU_MOUSE_LEFT,
@@ -283,6 +295,12 @@ int main(int argc, char **argv) {
         case MU_COMMAND_TEXT: r_draw_text(cmd->text.str, cmd->text.pos, cmd->text.color); break;
         case MU_COMMAND_RECT: r_draw_rect(cmd->rect.rect, cmd->rect.color); break;
         case MU_COMMAND_ICON: r_draw_icon(cmd->icon.id, cmd->icon.rect, cmd->icon.color); break;
+        case MU_COMMAND_BOX: draw_box(cmd->box.rect, cmd->box.color); break;
+        case MU_COMMAND_FRAME:
+          r_draw_rect(cmd->frame.rect, cmd->frame.color);
+          draw_box(mu_rect(cmd->frame.rect.x - 1, cmd->frame.rect.y - 1,
+            cmd->frame.rect.w + 2, cmd->frame.rect.h + 2), cmd->frame.border);
+          break;
         case MU_COMMAND_CLIP: r_set_clip_rect(cmd->clip.rect); break;
       }
     }
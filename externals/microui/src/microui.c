@@ -20,6 +20,7 @@
 ** IN THE SOFTWARE.
 */
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -47,9 +48,13 @@
   } while (0)
 
 
-static mu_Rect unclipped_rect = { 0, 0, 0x1000000, 0x1000000 };
+/* zindex values are renumbered from 1 once they pass this */
+#define ZINDEX_LIMIT 0x40000000
 
-static mu_Style default_style = {
+/* read-only; separate contexts may be used from different threads at once */
+static const mu_Rect unclipped_rect = { 0, 0, 0x1000000, 0x1000000 };
+
+static const mu_Style default_style = {
   /* font | size | padding | spacing | indent */
   NULL, { 68, 10 }, 5, 4, 24,
   /* title_height | scrollbar_size | thumb_size */
@@ -116,14 +121,14 @@ static int rect_overlaps_vec2(mu_Rect r, mu_Vec2 p) {
 
 
 static void draw_frame(mu_Context *ctx, mu_Rect rect, int colorid) {
-  mu_draw_rect(ctx, rect, ctx->style->colors[colorid]);
   if (colorid == MU_COLOR_SCROLLBASE  ||
       colorid == MU_COLOR_SCROLLTHUMB ||
-      colorid == MU_COLOR_TITLEBG) { return; }
-  /* draw border */
-  if (ctx->style->colors[MU_COLOR_BORDER].a) {
-    mu_draw_box(ctx, expand_rect(rect, 1), ctx->style->colors[MU_COLOR_BORDER]);
+      colorid == MU_COLOR_TITLEBG || !ctx->style->colors[MU_COLOR_BORDER].a) {
+    mu_draw_rect(ctx, rect, ctx->style->colors[colorid]);
+    return;
   }
+  /* draw fill and border */
+  mu_draw_frame(ctx, rect, ctx->style->colors[colorid], ctx->style->colors[MU_COLOR_BORDER]);
 }
 
 
@@ -136,25 +141,23 @@ void mu_init(mu_Context *ctx) {
 
 
 void mu_begin(mu_Context *ctx) {
+  int zone = mu_zone_begin("mu_begin");
   expect(ctx->text_width && ctx->text_height);
   ctx->command_list.idx = 0;
-  ctx->root_list.idx = 0;
+  ctx->root_list.first = ctx->root_list.last = NULL;
   ctx->scroll_target = NULL;
   ctx->hover_root = ctx->next_hover_root;
   ctx->next_hover_root = NULL;
   ctx->mouse_delta.x = ctx->mouse_pos.x - ctx->last_mouse_pos.x;
   ctx->mouse_delta.y = ctx->mouse_pos.y - ctx->last_mouse_pos.y;
   ctx->frame++;
-}
-
-
-static int compare_zindex(const void *a, const void *b) {
-  return (*(mu_Container**) a)->zindex - (*(mu_Container**) b)->zindex;
+  mu_zone_end(zone);
 }
 
 
 void mu_end(mu_Context *ctx) {
-  int i, n;
+  mu_Container *cnt, *prev = NULL;
+  int zone = mu_zone_begin("mu_end");
   /* check stacks */
   expect(ctx->container_stack.idx == 0);
   expect(ctx->clip_stack.idx      == 0);
@@ -186,27 +189,33 @@ void mu_end(mu_Context *ctx) {
   ctx->scroll_delta = mu_vec2(0, 0);
   ctx->last_mouse_pos = ctx->mouse_pos;
 
-  /* sort root containers by zindex */
-  n = ctx->root_list.idx;
-  qsort(ctx->root_list.items, n, sizeof(mu_Container*), compare_zindex);
-
-  /* set root container jump commands */
-  for (i = 0; i < n; i++) {
-    mu_Container *cnt = ctx->root_list.items[i];
+  /* set root container jump commands; the z-order holds every container
+  ** back to front, and those not begun as roots this frame are skipped */
+  for (cnt = ctx->z_order.back; cnt; cnt = cnt->z.next) {
+    if (cnt->root_frame != ctx->frame) { continue; }
     /* if this is the first container then make the first command jump to it.
     ** otherwise set the previous container's tail to jump to this one */
-    if (i == 0) {
+    if (!prev) {
       mu_Command *cmd = (mu_Command*) ctx->command_list.items;
       cmd->jump.dst = (char*) cnt->head + sizeof(mu_JumpCommand);
     } else {
-      mu_Container *prev = ctx->root_list.items[i - 1];
       prev->tail->jump.dst = (char*) cnt->head + sizeof(mu_JumpCommand);
     }
-    /* make the last container's tail jump to the end of command list */
-    if (i == n - 1) {
-      cnt->tail->jump.dst = ctx->command_list.items + ctx->command_list.idx;
+    prev = cnt;
+  }
+  /* make the last container's tail jump to the end of command list */
+  if (prev) {
+    prev->tail->jump.dst = ctx->command_list.items + ctx->command_list.idx;
+  }
+
+  /* renumber the order before zindex can overflow */
+  if (ctx->last_zindex > ZINDEX_LIMIT) {
+    ctx->last_zindex = 0;
+    for (cnt = ctx->z_order.back; cnt; cnt = cnt->z.next) {
+      cnt->zindex = ++ctx->last_zindex;
     }
   }
+  mu_zone_end(zone);
 }
 
 
@@ -216,6 +225,99 @@ void mu_set_focus(mu_Context *ctx, mu_Id id) {
 }
 
 
+void mu_shard_begin(mu_Context *ctx, mu_Context *shard) {
+  shard->text_width = ctx->text_width;
+  shard->text_height = ctx->text_height;
+  shard->draw_frame = ctx->draw_frame;
+  /* shared, so style edits must not happen while shards are building */
+  shard->style = ctx->style;
+  shard->hover = ctx->hover;
+  shard->focus = ctx->focus;
+  shard->last_id = ctx->last_id;
+  shard->updated_focus = 0;
+  shard->last_zindex = ctx->last_zindex;
+  shard->frame = ctx->frame;
+  shard->hover_root = ctx->hover_root;
+  shard->next_hover_root = NULL;
+  shard->scroll_target = NULL;
+  shard->number_edit = ctx->number_edit;
+  memcpy(shard->number_edit_buf, ctx->number_edit_buf, sizeof(ctx->number_edit_buf));
+  shard->command_list.idx = 0;
+  shard->root_list.first = shard->root_list.last = NULL;
+  shard->mouse_pos = ctx->mouse_pos;
+  shard->last_mouse_pos = ctx->last_mouse_pos;
+  shard->mouse_delta = ctx->mouse_delta;
+  shard->scroll_delta = ctx->scroll_delta;
+  shard->mouse_down = ctx->mouse_down;
+  shard->mouse_pressed = ctx->mouse_pressed;
+  shard->key_down = ctx->key_down;
+  shard->key_pressed = ctx->key_pressed;
+  memcpy(shard->input_text, ctx->input_text, sizeof(ctx->input_text));
+  shard->fork.hover = ctx->hover;
+  shard->fork.focus = ctx->focus;
+  shard->fork.number_edit = ctx->number_edit;
+  shard->fork.last_id = ctx->last_id;
+  shard->fork.last_zindex = ctx->last_zindex;
+  shard->fork.active = 1;
+}
+
+
+/* a shard's change wins if it set an id; clearing only wins while nobody
+** else has changed it since the fork */
+static void merge_id(mu_Id *dst, mu_Id forked, mu_Id changed) {
+  if (changed == forked) { return; }
+  if (changed || *dst == forked) { *dst = changed; }
+}
+
+
+void mu_shard_end(mu_Context *ctx, mu_Context *shard) {
+  int offset = ctx->command_list.idx, size = shard->command_list.idx;
+  mu_Container *cnt;
+  char *base = ctx->command_list.items + offset;
+  expect(shard->container_stack.idx == 0);
+  expect(shard->clip_stack.idx      == 0);
+  expect(shard->id_stack.idx        == 0);
+  expect(shard->layout_stack.idx    == 0);
+  expect(offset + size < MU_COMMANDLIST_SIZE);
+
+  /* append the commands; only the roots' head and tail jumps hold
+  ** pointers, and mu_end() sets the tails */
+  memcpy(base, shard->command_list.items, size);
+  ctx->command_list.idx += size;
+  for (cnt = shard->root_list.first; cnt; cnt = cnt->next_root) {
+    cnt->head = (mu_Command*) (base + ((char*) cnt->head - shard->command_list.items));
+    cnt->tail = (mu_Command*) (base + ((char*) cnt->tail - shard->command_list.items));
+    cnt->head->jump.dst = base + ((char*) cnt->head->jump.dst - shard->command_list.items);
+    /* windows brought to front in the shard go on top, in shard order */
+    if (cnt->zindex > shard->fork.last_zindex) { mu_bring_to_front(ctx, cnt); }
+  }
+  if (shard->root_list.first) {
+    if (ctx->root_list.last) { ctx->root_list.last->next_root = shard->root_list.first; }
+    else { ctx->root_list.first = shard->root_list.first; }
+    ctx->root_list.last = shard->root_list.last;
+  }
+
+  if (shard->next_hover_root &&
+      (!ctx->next_hover_root || shard->next_hover_root->zindex > ctx->next_hover_root->zindex)
+  ) {
+    ctx->next_hover_root = shard->next_hover_root;
+  }
+  if (shard->scroll_target) { ctx->scroll_target = shard->scroll_target; }
+  if (shard->updated_focus) { ctx->updated_focus = 1; }
+  merge_id(&ctx->hover, shard->fork.hover, shard->hover);
+  merge_id(&ctx->focus, shard->fork.focus, shard->focus);
+  if (shard->number_edit != shard->fork.number_edit ||
+      (shard->number_edit && strcmp(shard->number_edit_buf, ctx->number_edit_buf))
+  ) {
+    ctx->number_edit = shard->number_edit;
+    memcpy(ctx->number_edit_buf, shard->number_edit_buf, sizeof(ctx->number_edit_buf));
+  }
+  /* as if the shards' windows had been built in merge order; a shard that
+  ** built nothing leaves the previous shard's id */
+  if (shard->last_id != shard->fork.last_id) { ctx->last_id = shard->last_id; }
+}
+
+
 /* 32bit fnv-1a hash */
 #define HASH_INITIAL 2166136261
 
@@ -321,7 +423,8 @@ static mu_Container* get_container(mu_Context *ctx, mu_Id id, int opt) {
   /* container not found in pool: init new container */
   idx = mu_pool_init(ctx, ctx->container_pool, MU_CONTAINERPOOL_SIZE, id);
   cnt = &ctx->containers[idx];
-  memset(cnt, 0, sizeof(*cnt));
+  /* a reused slot keeps its place in the z-order until brought to front */
+  memset(&cnt->next_root, 0, sizeof(*cnt) - offsetof(mu_Container, next_root));
   cnt->open = 1;
   mu_bring_to_front(ctx, cnt);
   return cnt;
@@ -336,6 +439,17 @@ mu_Container* mu_get_container(mu_Context *ctx, const char *name) {
 
 void mu_bring_to_front(mu_Context *ctx, mu_Container *cnt) {
   cnt->zindex = ++ctx->last_zindex;
+  /* a shard's containers are relinked by its parent in mu_shard_end() */
+  if (ctx->fork.active || ctx->z_order.front == cnt) { return; }
+  /* unlink, if linked, and append at the front */
+  if (cnt->z.prev) { cnt->z.prev->z.next = cnt->z.next; }
+  else if (ctx->z_order.back == cnt) { ctx->z_order.back = cnt->z.next; }
+  if (cnt->z.next) { cnt->z.next->z.prev = cnt->z.prev; }
+  cnt->z.prev = ctx->z_order.front;
+  cnt->z.next = NULL;
+  if (ctx->z_order.front) { ctx->z_order.front->z.next = cnt; }
+  else { ctx->z_order.back = cnt; }
+  ctx->z_order.front = cnt;
 }
 
 
@@ -475,6 +589,14 @@ void mu_draw_rect(mu_Context *ctx, mu_Rect rect, mu_Color color) {
 
 
 void mu_draw_box(mu_Context *ctx, mu_Rect rect, mu_Color color) {
+  mu_Command *cmd;
+  /* one command unless the edges need clipping */
+  if (mu_check_clip(ctx, rect) == 0) {
+    cmd = mu_push_command(ctx, MU_COMMAND_BOX, sizeof(mu_BoxCommand));
+    cmd->box.rect = rect;
+    cmd->box.color = color;
+    return;
+  }
   mu_draw_rect(ctx, mu_rect(rect.x + 1, rect.y, rect.w - 2, 1), color);
   mu_draw_rect(ctx, mu_rect(rect.x + 1, rect.y + rect.h - 1, rect.w - 2, 1), color);
   mu_draw_rect(ctx, mu_rect(rect.x, rect.y, 1, rect.h), color);
@@ -482,6 +604,21 @@ void mu_draw_box(mu_Context *ctx, mu_Rect rect, mu_Color color) {
 }
 
 
+void mu_draw_frame(mu_Context *ctx, mu_Rect rect, mu_Color color, mu_Color border) {
+  mu_Command *cmd;
+  /* one command unless the frame needs clipping */
+  if (mu_check_clip(ctx, expand_rect(rect, 1)) == 0) {
+    cmd = mu_push_command(ctx, MU_COMMAND_FRAME, sizeof(mu_FrameCommand));
+    cmd->frame.rect = rect;
+    cmd->frame.color = color;
+    cmd->frame.border = border;
+    return;
+  }
+  mu_draw_rect(ctx, rect, color);
+  mu_draw_box(ctx, expand_rect(rect, 1), border);
+}
+
+
 void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len,
   mu_Vec2 pos, mu_Color color)
 {
@@ -526,14 +663,123 @@ void mu_draw_icon(mu_Context *ctx, int id, mu_Rect rect, mu_Color color) {
 
 enum { RELATIVE = 1, ABSOLUTE = 2 };
 
+/* layout cache, compiled in with MU_LAYOUT_CACHE: a container's
+** mu_layout_next() results are kept in a chain of items, each keyed by a
+** hash of every layout call since its body began (body rect and scroll,
+** style metrics, rows, widths, indents ..). an item is a pure function of
+** that history, so when the hash matches the item at the chain's cursor the
+** call replays it instead of recomputing; the first mismatch ends replay for
+** the rest of the body and records from there. resizing, scrolling or a
+** style change alters the initial hash, so nothing stale is ever replayed */
+enum {
+  LAYOUT_ROW = 1, LAYOUT_WIDTH, LAYOUT_HEIGHT, LAYOUT_SET_NEXT, LAYOUT_NEXT,
+  LAYOUT_BEGIN_COLUMN, LAYOUT_END_COLUMN, LAYOUT_INDENT
+};
+
+
+static mu_Container* layout_container(mu_Context *ctx) {
+  return ctx->container_stack.items[ctx->container_stack.idx - 1];
+}
+
+
+#ifdef MU_LAYOUT_CACHE
+
+static void layout_hash(mu_Container *cnt, int value) {
+  mu_Id h = (cnt->layout_cache.hash ^ (mu_Id) value) * 16777619;
+  cnt->layout_cache.hash = h ^ (h >> 15);
+}
+
+
+static void layout_hash_rect(mu_Container *cnt, mu_Rect r) {
+  layout_hash(cnt, r.x);
+  layout_hash(cnt, r.y);
+  layout_hash(cnt, r.w);
+  layout_hash(cnt, r.h);
+}
+
+
+/* `body` is the scrolled layout body the container has just pushed */
+static void begin_layout_cache(mu_Context *ctx, mu_Container *cnt, mu_Rect body) {
+  mu_Style *style = ctx->style;
+  /* the arena is only reset between root containers, when no chain is
+  ** being followed */
+  if (ctx->layout_cache.full && ctx->container_stack.idx == 1) {
+    ctx->layout_cache.idx = 0;
+    ctx->layout_cache.full = 0;
+    ctx->layout_cache.generation++;
+  }
+  if (cnt->layout_cache.generation != ctx->layout_cache.generation) {
+    cnt->layout_cache.generation = ctx->layout_cache.generation;
+    cnt->layout_cache.head = 0;
+  }
+  cnt->layout_cache.hash = HASH_INITIAL;
+  cnt->layout_cache.cursor = cnt->layout_cache.head;
+  cnt->layout_cache.tail = 0;
+  layout_hash_rect(cnt, body);
+  layout_hash(cnt, style->size.x);
+  layout_hash(cnt, style->size.y);
+  layout_hash(cnt, style->padding);
+  layout_hash(cnt, style->spacing);
+}
+
+
+static mu_LayoutCacheItem* layout_cache_lookup(mu_Context *ctx, mu_Container *cnt) {
+  mu_LayoutCacheItem *item;
+  if (!cnt->layout_cache.cursor) { return NULL; }
+  item = &ctx->layout_cache.items[cnt->layout_cache.cursor - 1];
+  if (item->hash != cnt->layout_cache.hash) {
+    cnt->layout_cache.cursor = 0;
+    return NULL;
+  }
+  cnt->layout_cache.tail = cnt->layout_cache.cursor;
+  cnt->layout_cache.cursor = item->next;
+  return item;
+}
+
+
+static void layout_cache_record(mu_Context *ctx, mu_Container *cnt, mu_Layout *layout, mu_Rect rect) {
+  mu_LayoutCacheItem *item;
+  if (ctx->layout_cache.idx == MU_LAYOUTCACHE_SIZE) {
+    ctx->layout_cache.full = 1;
+    return;
+  }
+  item = &ctx->layout_cache.items[ctx->layout_cache.idx++];
+  item->hash = cnt->layout_cache.hash;
+  item->next = 0;
+  item->rect = rect;
+  item->position = layout->position;
+  item->max = layout->max;
+  item->next_row = layout->next_row;
+  item->item_index = layout->item_index;
+  if (cnt->layout_cache.tail) {
+    ctx->layout_cache.items[cnt->layout_cache.tail - 1].next = ctx->layout_cache.idx;
+  } else {
+    cnt->layout_cache.head = ctx->layout_cache.idx;
+  }
+  cnt->layout_cache.tail = ctx->layout_cache.idx;
+}
+
+#else
+
+static void layout_hash(mu_Container *cnt, int value) {}
+static void layout_hash_rect(mu_Container *cnt, mu_Rect r) {}
+static void begin_layout_cache(mu_Context *ctx, mu_Container *cnt, mu_Rect body) {}
+static mu_LayoutCacheItem* layout_cache_lookup(mu_Context *ctx, mu_Container *cnt) { return NULL; }
+static void layout_cache_record(mu_Context *ctx, mu_Container *cnt, mu_Layout *layout, mu_Rect rect) {}
+
+#endif
+
 
 void mu_layout_begin_column(mu_Context *ctx) {
-  push_layout(ctx, mu_layout_next(ctx), mu_vec2(0, 0));
+  mu_Rect body = mu_layout_next(ctx);
+  layout_hash(layout_container(ctx), LAYOUT_BEGIN_COLUMN);
+  push_layout(ctx, body, mu_vec2(0, 0));
 }
 
 
 void mu_layout_end_column(mu_Context *ctx) {
   mu_Layout *a, *b;
+  layout_hash(layout_container(ctx), LAYOUT_END_COLUMN);
   b = get_layout(ctx);
   pop(ctx->layout_stack);
   /* inherit position/next_row/max from child layout if they are greater */
@@ -545,8 +791,7 @@ void mu_layout_end_column(mu_Context *ctx) {
 }
 
 
-void mu_layout_row(mu_Context *ctx, int items, const int *widths, int height) {
-  mu_Layout *layout = get_layout(ctx);
+static void layout_row(mu_Layout *layout, int items, const int *widths, int height) {
   if (widths) {
     expect(items <= MU_MAX_WIDTHS);
     memcpy(layout->widths, widths, items * sizeof(widths[0]));
@@ -558,26 +803,58 @@ void mu_layout_row(mu_Context *ctx, int items, const int *widths, int height) {
 }
 
 
+void mu_layout_row(mu_Context *ctx, int items, const int *widths, int height) {
+  mu_Container *cnt = layout_container(ctx);
+  mu_Layout *layout = get_layout(ctx);
+  int i;
+  layout_hash(cnt, LAYOUT_ROW);
+  layout_hash(cnt, items);
+  layout_hash(cnt, height);
+  if (widths) {
+    for (i = 0; i < items; i++) { layout_hash(cnt, widths[i]); }
+  } else {
+    layout_hash(cnt, -0x7fffffff);
+  }
+  layout_row(layout, items, widths, height);
+}
+
+
+static void layout_indent(mu_Context *ctx, int delta) {
+  mu_Container *cnt = layout_container(ctx);
+  layout_hash(cnt, LAYOUT_INDENT);
+  layout_hash(cnt, delta);
+  get_layout(ctx)->indent += delta;
+}
+
+
 void mu_layout_width(mu_Context *ctx, int width) {
+  mu_Container *cnt = layout_container(ctx);
+  layout_hash(cnt, LAYOUT_WIDTH);
+  layout_hash(cnt, width);
   get_layout(ctx)->size.x = width;
 }
 
 
 void mu_layout_height(mu_Context *ctx, int height) {
+  mu_Container *cnt = layout_container(ctx);
+  layout_hash(cnt, LAYOUT_HEIGHT);
+  layout_hash(cnt, height);
   get_layout(ctx)->size.y = height;
 }
 
 
 void mu_layout_set_next(mu_Context *ctx, mu_Rect r, int relative) {
+  mu_Container *cnt = layout_container(ctx);
   mu_Layout *layout = get_layout(ctx);
+  layout_hash(cnt, LAYOUT_SET_NEXT);
+  layout_hash(cnt, relative);
+  layout_hash_rect(cnt, r);
   layout->next = r;
   layout->next_type = relative ? RELATIVE : ABSOLUTE;
 }
 
 
-mu_Rect mu_layout_next(mu_Context *ctx) {
-  mu_Layout *layout = get_layout(ctx);
-  mu_Style *style = ctx->style;
+static mu_Rect layout_next(mu_Layout *layout, mu_Style *style) {
   mu_Rect res;
 
   if (layout->next_type) {
@@ -585,12 +862,12 @@ mu_Rect mu_layout_next(mu_Context *ctx) {
     int type = layout->next_type;
     layout->next_type = 0;
     res = layout->next;
-    if (type == ABSOLUTE) { return (ctx->last_rect = res); }
+    if (type == ABSOLUTE) { return res; }
 
   } else {
     /* handle next row */
     if (layout->item_index == layout->items) {
-      mu_layout_row(ctx, layout->items, NULL, layout->size.y);
+      layout_row(layout, layout->items, NULL, layout->size.y);
     }
 
     /* position */
@@ -620,26 +897,37 @@ mu_Rect mu_layout_next(mu_Context *ctx) {
   layout->max.x = mu_max(layout->max.x, res.x + res.w);
   layout->max.y = mu_max(layout->max.y, res.y + res.h);
 
-  return (ctx->last_rect = res);
+  return res;
 }
 
 
-/*============================================================================
-** controls
-**============================================================================*/
+mu_Rect mu_layout_next(mu_Context *ctx) {
+  mu_Container *cnt = layout_container(ctx);
+  mu_Layout *layout = get_layout(ctx);
+  mu_LayoutCacheItem *item;
+  mu_Rect res;
 
-static int in_hover_root(mu_Context *ctx) {
-  int i = ctx->container_stack.idx;
-  while (i--) {
-    if (ctx->container_stack.items[i] == ctx->hover_root) { return 1; }
-    /* only root containers have their `head` field set; stop searching if we've
-    ** reached the current root container */
-    if (ctx->container_stack.items[i]->head) { break; }
+  layout_hash(cnt, LAYOUT_NEXT);
+  item = layout_cache_lookup(ctx, cnt);
+  if (item) {
+    layout->next_type = 0;
+    layout->position = item->position;
+    layout->max = item->max;
+    layout->next_row = item->next_row;
+    layout->item_index = item->item_index;
+    return (ctx->last_rect = item->rect);
   }
-  return 0;
+
+  res = layout_next(layout, ctx->style);
+  layout_cache_record(ctx, cnt, layout, res);
+  return (ctx->last_rect = res);
 }
 
 
+/*============================================================================
+** controls
+**============================================================================*/
+
 void mu_draw_control_frame(mu_Context *ctx, mu_Id id, mu_Rect rect,
   int colorid, int opt)
 {
@@ -670,15 +958,20 @@ void mu_draw_control_text(mu_Context *ctx, const char *str, mu_Rect rect,
 
 
 int mu_mouse_over(mu_Context *ctx, mu_Rect rect) {
+  /* the hover root test is a comparison, not a walk up the container stack */
   return rect_overlaps_vec2(rect, ctx->mouse_pos) &&
-    rect_overlaps_vec2(mu_get_clip_rect(ctx), ctx->mouse_pos) &&
-    in_hover_root(ctx);
+    ctx->hover_root && ctx->current_root == ctx->hover_root &&
+    rect_overlaps_vec2(mu_get_clip_rect(ctx), ctx->mouse_pos);
 }
 
 
 void mu_update_control(mu_Context *ctx, mu_Id id, mu_Rect rect, int opt) {
   int mouseover = mu_mouse_over(ctx, rect);
 
+#ifdef MU_MEMO_WINDOWS
+  if (ctx->hover == id || ctx->focus == id) { ctx->memo.touched = 1; }
+#endif
+
   if (ctx->focus == id) { ctx->updated_focus = 1; }
   if (opt & MU_OPT_NOINTERACT) { return; }
   if (mouseover && !ctx->mouse_down) { ctx->hover = id; }
@@ -703,6 +996,7 @@ void mu_text(mu_Context *ctx, const char *text) {
   int width = -1;
   mu_Font font = ctx->style->font;
   mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
+  int zone = mu_zone_begin("mu_text");
   mu_layout_begin_column(ctx);
   mu_layout_row(ctx, 1, &width, ctx->text_height(font));
   do {
@@ -721,6 +1015,7 @@ void mu_text(mu_Context *ctx, const char *text) {
     p = end + 1;
   } while (*end);
   mu_layout_end_column(ctx);
+  mu_zone_end(zone);
 }
 
 
@@ -972,7 +1267,7 @@ int mu_header_ex(mu_Context *ctx, const char *label, int opt) {
 int mu_begin_treenode_ex(mu_Context *ctx, const char *label, int opt) {
   int res = header(ctx, label, 1, opt);
   if (res & MU_RES_ACTIVE) {
-    get_layout(ctx)->indent += ctx->style->indent;
+    layout_indent(ctx, ctx->style->indent);
     push(ctx->id_stack, ctx->last_id);
   }
   return res;
@@ -980,7 +1275,7 @@ int mu_begin_treenode_ex(mu_Context *ctx, const char *label, int opt) {
 
 
 void mu_end_treenode(mu_Context *ctx) {
-  get_layout(ctx)->indent -= ctx->style->indent;
+  layout_indent(ctx, -ctx->style->indent);
   mu_pop_id(ctx);
 }
 
@@ -1045,14 +1340,84 @@ static void push_container_body(
 ) {
   if (~opt & MU_OPT_NOSCROLL) { scrollbars(ctx, cnt, &body); }
   push_layout(ctx, expand_rect(body, -ctx->style->padding), cnt->scroll);
+  begin_layout_cache(ctx, cnt, get_layout(ctx)->body);
   cnt->body = body;
 }
 
 
+#ifdef MU_MEMO_WINDOWS
+
+/* moves the bodies that can still be replayed, those built or replayed last
+** frame or this one, to the front of the store */
+static void memo_compact(mu_Context *ctx) {
+  mu_Container *live[MU_CONTAINERPOOL_SIZE];
+  int i, j, n = 0, idx = 0;
+  for (i = 0; i < MU_CONTAINERPOOL_SIZE; i++) {
+    mu_Container *cnt = &ctx->containers[i];
+    if (!cnt->memo.frame || cnt->memo.frame < ctx->frame - 1) { continue; }
+    for (j = n++; j > 0 && live[j - 1]->memo.offset > cnt->memo.offset; j--) {
+      live[j] = live[j - 1];
+    }
+    live[j] = cnt;
+  }
+  for (i = 0; i < n; i++) {
+    memmove(ctx->memo.items + idx, ctx->memo.items + live[i]->memo.offset, live[i]->memo.size);
+    live[i]->memo.offset = idx;
+    idx += live[i]->memo.size;
+  }
+  ctx->memo.idx = idx;
+}
+
+
+/* keeps a freshly built root body for mu_begin_window_memo(), unless one of
+** its controls was interacted with */
+static void memo_store(mu_Context *ctx, mu_Container *cnt) {
+  char *body = (char*) cnt->head + cnt->head->base.size;
+  int size = (char*) cnt->tail - body;
+  cnt->memo.record = 0;
+  cnt->memo.frame = 0;
+  if (ctx->memo.touched) { return; }
+  if (ctx->memo.idx + size > MU_MEMOLIST_SIZE) { memo_compact(ctx); }
+  if (ctx->memo.idx + size > MU_MEMOLIST_SIZE) { return; }
+  memcpy(ctx->memo.items + ctx->memo.idx, body, size);
+  cnt->memo.offset = ctx->memo.idx;
+  cnt->memo.size = size;
+  cnt->memo.frame = ctx->frame;
+  ctx->memo.idx += size;
+}
+
+
+static void memo_begin_root(mu_Context *ctx, mu_Container *cnt) {
+  /* interaction is tracked per root: being under the mouse counts, and so
+  ** does beginning another root inside this one */
+  cnt->memo.outer_touched = ctx->memo.touched || ctx->container_stack.idx > 0;
+  ctx->memo.touched = ctx->hover_root == cnt;
+}
+
+
+static void memo_close_root(mu_Context *ctx, mu_Container *cnt) {
+  if (cnt->memo.record) { memo_store(ctx, cnt); }
+  ctx->memo.touched = cnt->memo.outer_touched;
+}
+
+#else
+
+static void memo_begin_root(mu_Context *ctx, mu_Container *cnt) {}
+static void memo_close_root(mu_Context *ctx, mu_Container *cnt) {}
+
+#endif
+
+
 static void begin_root_container(mu_Context *ctx, mu_Container *cnt) {
+  memo_begin_root(ctx, cnt);
   push(ctx->container_stack, cnt);
-  /* push container to roots list and push head command */
-  push(ctx->root_list, cnt);
+  ctx->current_root = cnt;
+  /* append container to this frame's roots and push head command */
+  cnt->root_frame = ctx->frame;
+  cnt->next_root = NULL;
+  if (ctx->root_list.last) { ctx->root_list.last->next_root = cnt; }
+  else { ctx->root_list.first = cnt; }
+  ctx->root_list.last = cnt;
   cnt->head = push_jump(ctx, NULL);
   /* set as hover root if the mouse is overlapping this container and it has a
   ** higher zindex than the current hover root */
@@ -1068,24 +1433,48 @@ static void begin_root_container(mu_Context *ctx, mu_Container *cnt) {
 }
 
 
-static void end_root_container(mu_Context *ctx) {
+static void close_root_container(mu_Context *ctx, mu_Container *cnt) {
   /* push tail 'goto' jump command and set head 'skip' command. the final steps
   ** on initing these are done in mu_end() */
-  mu_Container *cnt = mu_get_current_container(ctx);
   cnt->tail = push_jump(ctx, NULL);
   cnt->head->jump.dst = ctx->command_list.items + ctx->command_list.idx;
+  memo_close_root(ctx, cnt);
+}
+
+
+/* after a root is popped: the next root down the container stack, if any */
+static void restore_current_root(mu_Context *ctx) {
+  int i = ctx->container_stack.idx;
+  ctx->current_root = NULL;
+  while (i--) {
+    /* only root containers have their `head` field set */
+    if (ctx->container_stack.items[i]->head) {
+      ctx->current_root = ctx->container_stack.items[i];
+      break;
+    }
+  }
+}
+
+
+static void end_root_container(mu_Context *ctx) {
+  close_root_container(ctx, mu_get_current_container(ctx));
   /* pop base clip rect and container */
   mu_pop_clip_rect(ctx);
   pop_container(ctx);
+  restore_current_root(ctx);
 }
 
 
 int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt) {
   mu_Rect body;
-  mu_Id id = mu_get_id(ctx, title, strlen(title));
-  mu_Container *cnt = get_container(ctx, id, opt);
-  if (!cnt || !cnt->open) { return 0; }
+  mu_Id id;
+  mu_Container *cnt;
+  int zone = mu_zone_begin("mu_begin_window_ex");
+  id = mu_get_id(ctx, title, strlen(title));
+  cnt = get_container(ctx, id, opt);
+  if (!cnt || !cnt->open) { mu_zone_end(zone); return 0; }
   push(ctx->id_stack, id);
+  cnt->opt = opt;
 
   if (cnt->rect.w == 0) { cnt->rect = rect; }
   begin_root_container(ctx, cnt);
@@ -1155,6 +1544,7 @@ int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt
   }
 
   mu_push_clip_rect(ctx, cnt->body);
+  mu_zone_end(zone);
   return MU_RES_ACTIVE;
 }
 
@@ -1165,6 +1555,56 @@ void mu_end_window(mu_Context *ctx) {
 }
 
 
+#ifdef MU_MEMO_WINDOWS
+
+static void memo_key(mu_Context *ctx, mu_Container *cnt, int opt, unsigned version, mu_MemoKey *key) {
+  key->rect = cnt->rect;
+  key->scroll = cnt->scroll;
+  key->content_size = cnt->content_size;
+  key->focus = ctx->focus;
+  key->style = HASH_INITIAL;
+  hash(&key->style, ctx->style, sizeof(*ctx->style));
+  key->version = version;
+  key->opt = opt;
+}
+
+
+int mu_begin_window_memo(mu_Context *ctx, const char *title, mu_Rect rect, int opt, unsigned version) {
+  mu_MemoKey key;
+  mu_Id id = mu_get_id(ctx, title, strlen(title));
+  mu_Container *cnt = get_container(ctx, id, opt);
+  if (!cnt || !cnt->open) { return 0; }
+  memo_key(ctx, cnt, opt, version, &key);
+
+  /* replay: the root's jumps are made afresh around last frame's body */
+  if (~opt & MU_OPT_POPUP && ctx->hover_root != cnt &&
+      cnt->memo.frame && cnt->memo.frame == ctx->frame - 1 &&
+      memcmp(&key, &cnt->memo.key, sizeof(key)) == 0
+  ) {
+    int zone = mu_zone_begin("memo replay");
+    begin_root_container(ctx, cnt);
+    expect(ctx->command_list.idx + cnt->memo.size < MU_COMMANDLIST_SIZE);
+    memcpy(ctx->command_list.items + ctx->command_list.idx,
+      ctx->memo.items + cnt->memo.offset, cnt->memo.size);
+    ctx->command_list.idx += cnt->memo.size;
+    cnt->memo.frame = ctx->frame;
+    close_root_container(ctx, cnt);
+    pop(ctx->clip_stack);
+    pop(ctx->container_stack);
+    restore_current_root(ctx);
+    mu_zone_end(zone);
+    return 0;
+  }
+
+  if (!mu_begin_window_ex(ctx, title, rect, opt)) { return 0; }
+  cnt->memo.key = key;
+  cnt->memo.record = ~opt & MU_OPT_POPUP;
+  return MU_RES_ACTIVE;
+}
+
+#endif
+
+
 void mu_open_popup(mu_Context *ctx, const char *name) {
   mu_Container *cnt = mu_get_container(ctx, name);
   /* set as hover root so popup isn't closed in begin_window_ex()  */
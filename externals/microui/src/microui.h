@@ -11,14 +11,18 @@
 #define MU_VERSION "2.02"
 
 #define MU_COMMANDLIST_SIZE     (256 * 1024)
-#define MU_ROOTLIST_SIZE        32
 #define MU_CONTAINERSTACK_SIZE  32
 #define MU_CLIPSTACK_SIZE       32
 #define MU_IDSTACK_SIZE         32
 #define MU_LAYOUTSTACK_SIZE     16
-#define MU_CONTAINERPOOL_SIZE   48
+/* every window and panel takes a slot, including all roots of a frame */
+#ifndef MU_CONTAINERPOOL_SIZE
+#define MU_CONTAINERPOOL_SIZE   128
+#endif
 #define MU_TREENODEPOOL_SIZE    48
 #define MU_MAX_WIDTHS           16
+#define MU_LAYOUTCACHE_SIZE     8192
+#define MU_MEMOLIST_SIZE        (256 * 1024)
 #define MU_REAL                 float
 #define MU_REAL_FMT             "%.3g"
 #define MU_SLIDER_FMT           "%.2f"
@@ -29,6 +33,21 @@
 #define mu_max(a, b)            ((a) > (b) ? (a) : (b))
 #define mu_clamp(x, a, b)       mu_min(b, mu_max(a, x))
 
+/* profiling zones: compiled out unless MU_TRACE is defined, in which case the
+** application provides the hooks. mu_zone_begin() reads the flag once and
+** returns it, and mu_zone_end() takes that value, so a zone stays balanced
+** when tracing is toggled inside it */
+#ifdef MU_TRACE
+extern int mu_trace_enabled;
+void mu_trace_begin(const char *name);
+void mu_trace_end(void);
+#define mu_zone_begin(name) (mu_trace_enabled ? (mu_trace_begin(name), 1) : 0)
+#define mu_zone_end(zone)   do { if (zone) { mu_trace_end(); } } while (0)
+#else
+#define mu_zone_begin(name) 0
+#define mu_zone_end(zone)   ((void) (zone))
+#endif
+
 enum {
   MU_CLIP_PART = 1,
   MU_CLIP_ALL
@@ -40,6 +59,8 @@ enum {
   MU_COMMAND_RECT,
   MU_COMMAND_TEXT,
   MU_COMMAND_ICON,
+  MU_COMMAND_BOX,
+  MU_COMMAND_FRAME,
   MU_COMMAND_MAX
 };
 
@@ -107,6 +128,7 @@ enum {
 
 
 typedef struct mu_Context mu_Context;
+typedef struct mu_Container mu_Container;
 typedef unsigned mu_Id;
 typedef MU_REAL mu_Real;
 typedef void* mu_Font;
@@ -122,6 +144,10 @@ typedef struct { mu_BaseCommand base; mu_Rect rect; } mu_ClipCommand;
 typedef struct { mu_BaseCommand base; mu_Rect rect; mu_Color color; } mu_RectCommand;
 typedef struct { mu_BaseCommand base; mu_Font font; mu_Vec2 pos; mu_Color color; char str[1]; } mu_TextCommand;
 typedef struct { mu_BaseCommand base; mu_Rect rect; int id; mu_Color color; } mu_IconCommand;
+/* a 1-pixel outline inside `rect`, as the four edges mu_draw_box() draws */
+typedef struct { mu_BaseCommand base; mu_Rect rect; mu_Color color; } mu_BoxCommand;
+/* `rect` filled with `color`, and a 1-pixel `border` box just outside it */
+typedef struct { mu_BaseCommand base; mu_Rect rect; mu_Color color, border; } mu_FrameCommand;
 
 typedef union {
   int type;
@@ -131,6 +157,8 @@ typedef union {
   mu_RectCommand rect;
   mu_TextCommand text;
   mu_IconCommand icon;
+  mu_BoxCommand box;
+  mu_FrameCommand frame;
 } mu_Command;
 
 typedef struct {
@@ -147,7 +175,39 @@ typedef struct {
   int indent;
 } mu_Layout;
 
+/* a mu_layout_next() result and the layout state after it, keyed by a hash
+** of every layout call since the container's body began. the cache is
+** compiled in only when MU_LAYOUT_CACHE is defined */
+typedef struct {
+  mu_Id hash;
+  int next;
+  mu_Rect rect;
+  mu_Vec2 position;
+  mu_Vec2 max;
+  int next_row;
+  int item_index;
+} mu_LayoutCacheItem;
+
+/* everything a memoized window's body is built from. memoized windows are
+** compiled in only when MU_MEMO_WINDOWS is defined */
 typedef struct {
+  mu_Rect rect;
+  mu_Vec2 scroll;
+  mu_Vec2 content_size;
+  mu_Id focus;
+  mu_Id style;
+  unsigned version;
+  int opt;
+} mu_MemoKey;
+
+struct mu_Container {
+  /* neighbours in the context's back-to-front order of containers. kept
+  ** when the pool slot is reused, so a shard never relinks its parent's
+  ** order from another thread */
+  struct { mu_Container *prev, *next; } z;
+  /* the next root begun after this one in `root_frame` */
+  mu_Container *next_root;
+  int root_frame;
   mu_Command *head, *tail;
   mu_Rect rect;
   mu_Rect body;
@@ -155,7 +215,18 @@ typedef struct {
   mu_Vec2 scroll;
   int zindex;
   int open;
-} mu_Container;
+  /* the options a window was last begun with */
+  int opt;
+#ifdef MU_MEMO_WINDOWS
+  /* commands of the body kept by mu_begin_window_memo(); `frame` is the
+  ** last frame they were built or replayed in */
+  struct { mu_MemoKey key; int frame, offset, size, record, outer_touched; } memo;
+#endif
+#ifdef MU_LAYOUT_CACHE
+  /* this container's chain of layout cache items (1-based, 0 ends it) */
+  struct { mu_Id hash; int generation, head, cursor, tail; } layout_cache;
+#endif
+};
 
 typedef struct {
   mu_Font font;
@@ -187,11 +258,17 @@ struct mu_Context {
   mu_Container *hover_root;
   mu_Container *next_hover_root;
   mu_Container *scroll_target;
+  /* innermost root being built; controls can only be hovered while it is
+  ** the hover root */
+  mu_Container *current_root;
   char number_edit_buf[MU_MAX_FMT];
   mu_Id number_edit;
   /* stacks */
   mu_stack(char, MU_COMMANDLIST_SIZE) command_list;
-  mu_stack(mu_Container*, MU_ROOTLIST_SIZE) root_list;
+  /* containers back to front; only mu_bring_to_front() relinks them */
+  struct { mu_Container *back, *front; } z_order;
+  /* this frame's roots in the order they were begun */
+  struct { mu_Container *first, *last; } root_list;
   mu_stack(mu_Container*, MU_CONTAINERSTACK_SIZE) container_stack;
   mu_stack(mu_Rect, MU_CLIPSTACK_SIZE) clip_stack;
   mu_stack(mu_Id, MU_IDSTACK_SIZE) id_stack;
@@ -200,6 +277,17 @@ struct mu_Context {
   mu_PoolItem container_pool[MU_CONTAINERPOOL_SIZE];
   mu_Container containers[MU_CONTAINERPOOL_SIZE];
   mu_PoolItem treenode_pool[MU_TREENODEPOOL_SIZE];
+#ifdef MU_MEMO_WINDOWS
+  /* store of memoized bodies; `touched` is set while the root being built
+  ** is under the mouse or has a hovered or focused control */
+  struct { int idx, touched; char items[MU_MEMOLIST_SIZE]; } memo;
+#endif
+#ifdef MU_LAYOUT_CACHE
+  struct {
+    int idx, generation, full;
+    mu_LayoutCacheItem items[MU_LAYOUTCACHE_SIZE];
+  } layout_cache;
+#endif
   /* input state */
   mu_Vec2 mouse_pos;
   mu_Vec2 last_mouse_pos;
@@ -210,6 +298,8 @@ struct mu_Context {
   int key_down;
   int key_pressed;
   char input_text[32];
+  /* parent state when this context was forked as a shard */
+  struct { mu_Id hover, focus, number_edit, last_id; int last_zindex, active; } fork;
 };
 
 
@@ -221,6 +311,17 @@ void mu_init(mu_Context *ctx);
 void mu_begin(mu_Context *ctx);
 void mu_end(mu_Context *ctx);
 void mu_set_focus(mu_Context *ctx, mu_Id id);
+/* parallel root windows: a shard is a second context that builds some of the
+** frame's root windows, e.g. on another thread. between mu_begin() and
+** mu_end(), mu_shard_begin() forks the input, hover, focus and last_id state
+** into it; the shard then runs only mu_begin_window() .. mu_end_window()
+** blocks; mu_shard_end() appends its commands and root windows to `ctx`,
+** merges hover, focus and scroll state and hands back the shard's last_id,
+** so after the last merge it is what a serial build would have left. keep
+** the shard alive as long as `ctx` and give it the same windows every frame:
+** their containers live in its pools and are linked into `ctx`'s z-order */
+void mu_shard_begin(mu_Context *ctx, mu_Context *shard);
+void mu_shard_end(mu_Context *ctx, mu_Context *shard);
 mu_Id mu_get_id(mu_Context *ctx, const void *data, int size);
 void mu_push_id(mu_Context *ctx, const void *data, int size);
 void mu_pop_id(mu_Context *ctx);
@@ -249,6 +350,7 @@ int mu_next_command(mu_Context *ctx, mu_Command **cmd);
 void mu_set_clip(mu_Context *ctx, mu_Rect rect);
 void mu_draw_rect(mu_Context *ctx, mu_Rect rect, mu_Color color);
 void mu_draw_box(mu_Context *ctx, mu_Rect rect, mu_Color color);
+void mu_draw_frame(mu_Context *ctx, mu_Rect rect, mu_Color color, mu_Color border);
 void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len, mu_Vec2 pos, mu_Color color);
 void mu_draw_icon(mu_Context *ctx, int id, mu_Rect rect, mu_Color color);
 
@@ -287,6 +389,21 @@ int mu_begin_treenode_ex(mu_Context *ctx, const char *label, int opt);
 void mu_end_treenode(mu_Context *ctx);
 int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt);
 void mu_end_window(mu_Context *ctx);
+/* a window whose body can be skipped: when `version` and the window's rect,
+** scroll, content size, options, style and the focused id are unchanged,
+** and neither last frame nor now is it under the mouse or holding the
+** hovered or focused control, the previous frame's commands are replayed
+** and 0 is returned, so neither the body nor mu_end_window() runs. bump
+** `version` whenever the data shown in the body changes, including state
+** the body sets on its panels. replayed bodies don't touch their panels and
+** treenodes, so with full pools those can be evicted. popups are never
+** replayed. without MU_MEMO_WINDOWS this is mu_begin_window_ex() and
+** `version` is not evaluated */
+#ifdef MU_MEMO_WINDOWS
+int mu_begin_window_memo(mu_Context *ctx, const char *title, mu_Rect rect, int opt, unsigned version);
+#else
+#define mu_begin_window_memo(ctx, title, rect, opt, version) mu_begin_window_ex(ctx, title, rect, opt)
+#endif
 void mu_open_popup(mu_Context *ctx, const char *name);
 int mu_begin_popup(mu_Context *ctx, const char *name);
 void mu_end_popup(mu_Context *ctx);
@@ -0,0 +1,10 @@
+#!/bin/bash
+# builds the batch thumbnail renderer (no GLFW or GL needed); run from this directory
+
+CFLAGS="-I. -I../src -I../externals/microui/src -Wall -O2 -g"
+
+gcc -std=c11 -c ../externals/microui/src/microui.c -o microui.o $CFLAGS || exit 1
+
+g++ -std=c++20 $CFLAGS -o microui-snapshot snapshot.cpp png.cpp raster.cpp status_panel.cpp \
+  ../src/alloc_track.cpp ../src/batch.cpp ../src/cmdlist.cpp ../src/perf_stats.cpp ../src/thread_pool.cpp \
+  ../src/trace.cpp microui.o -lpthread
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdio.h>
+#include "png.h"
+
+#define HASH_BITS   15
+#define WINDOW_SIZE 32768
+#define MIN_MATCH   3
+#define MAX_MATCH   258
+
+static const unsigned short length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const unsigned char length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned short dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const unsigned char dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+
+static unsigned reverse_bits(unsigned code, int len) {
+  unsigned res = 0;
+  for (int i = 0; i < len; i++) { res = (res << 1) | ((code >> i) & 1); }
+  return res;
+}
+
+
+/* the fixed literal/length code of RFC 1951 3.2.6, pre-reversed for an
+** LSB-first bit writer, plus lookups from match length/distance to symbol */
+struct Tables {
+  unsigned short lit_code[288];
+  unsigned char lit_len[288];
+  unsigned char dist_code[32];
+  unsigned char length_sym[MAX_MATCH + 1];
+  unsigned crc[256];
+
+  Tables() {
+    for (int i = 0; i < 288; i++) {
+      unsigned code; int len;
+      if (i < 144)      { code = 0x30 + i;          len = 8; }
+      else if (i < 256) { code = 0x190 + (i - 144); len = 9; }
+      else if (i < 280) { code = i - 256;           len = 7; }
+      else              { code = 0xc0 + (i - 280);  len = 8; }
+      lit_code[i] = static_cast<unsigned short>(reverse_bits(code, len));
+      lit_len[i] = static_cast<unsigned char>(len);
+    }
+    for (int i = 0; i < 32; i++) { dist_code[i] = static_cast<unsigned char>(reverse_bits(i, 5)); }
+    for (int sym = 0; sym < 29; sym++) {
+      int last = sym == 28 ? MAX_MATCH : length_base[sym] + (1 << length_extra[sym]) - 1;
+      for (int l = length_base[sym]; l <= last; l++) { length_sym[l] = static_cast<unsigned char>(sym); }
+    }
+    /* a length of 258 has its own symbol rather than 227 + 31 */
+    length_sym[MAX_MATCH] = 28;
+    for (unsigned n = 0; n < 256; n++) {
+      unsigned c = n;
+      for (int k = 0; k < 8; k++) { c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1; }
+      crc[n] = c;
+    }
+  }
+};
+
+static const Tables& tables() {
+  static const Tables t;
+  return t;
+}
+
+
+static int dist_symbol(int dist) {
+  int sym = 0;
+  while (sym < 29 && dist_base[sym + 1] <= dist) { sym++; }
+  return sym;
+}
+
+
+struct BitWriter {
+  std::vector<unsigned char>* out;
+  unsigned long long bits;
+  int count;
+
+  void put(unsigned value, int len) {
+    bits |= static_cast<unsigned long long>(value) << count;
+    count += len;
+    while (count >= 8) {
+      out->push_back(static_cast<unsigned char>(bits));
+      bits >>= 8;
+      count -= 8;
+    }
+  }
+
+  void finish() {
+    if (count > 0) { out->push_back(static_cast<unsigned char>(bits)); }
+    bits = 0;
+    count = 0;
+  }
+};
+
+
+static unsigned hash3(const unsigned char* p) {
+  unsigned v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+
+static void deflate_fixed(PngEncoder* enc, const unsigned char* data, int size) {
+  const Tables& t = tables();
+  enc->head.assign(1 << HASH_BITS, -WINDOW_SIZE - 1);
+  BitWriter bw = { &enc->out, 0, 0 };
+  bw.put(1, 1);  /* BFINAL */
+  bw.put(1, 2);  /* BTYPE = fixed Huffman */
+
+  int i = 0;
+  while (i < size) {
+    int len = 0, dist = 0;
+    if (i + MIN_MATCH <= size) {
+      unsigned h = hash3(data + i);
+      int cand = enc->head[h];
+      enc->head[h] = i;
+      if (i - cand <= WINDOW_SIZE) {
+        int max = std::min(MAX_MATCH, size - i);
+        while (len < max && data[cand + len] == data[i + len]) { len++; }
+        dist = i - cand;
+      }
+    }
+    if (len < MIN_MATCH) {
+      bw.put(t.lit_code[data[i]], t.lit_len[data[i]]);
+      i++;
+      continue;
+    }
+    int ls = t.length_sym[len];
+    bw.put(t.lit_code[257 + ls], t.lit_len[257 + ls]);
+    bw.put(len - length_base[ls], length_extra[ls]);
+    int ds = dist_symbol(dist);
+    bw.put(t.dist_code[ds], 5);
+    bw.put(dist - dist_base[ds], dist_extra[ds]);
+    /* only the tail of a match is hashed; plenty for runs of flat color */
+    int end = i + len;
+    for (int k = std::max(i + 1, end - 3); k < end && k + MIN_MATCH <= size; k++) {
+      enc->head[hash3(data + k)] = k;
+    }
+    i = end;
+  }
+  bw.put(t.lit_code[256], t.lit_len[256]);
+  bw.finish();
+}
+
+
+static unsigned adler32(const unsigned char* data, size_t size) {
+  unsigned a = 1, b = 0;
+  while (size > 0) {
+    /* 5552 is the longest run that can't overflow before the modulo */
+    size_t n = std::min(size, static_cast<size_t>(5552));
+    size -= n;
+    while (n--) { a += *data++; b += a; }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+
+static void put_u32(std::vector<unsigned char>* out, unsigned v) {
+  out->push_back(static_cast<unsigned char>(v >> 24));
+  out->push_back(static_cast<unsigned char>(v >> 16));
+  out->push_back(static_cast<unsigned char>(v >> 8));
+  out->push_back(static_cast<unsigned char>(v));
+}
+
+
+/* patches in the length of the chunk started at `start` and appends its CRC */
+static void end_chunk(std::vector<unsigned char>* out, size_t start) {
+  unsigned len = static_cast<unsigned>(out->size() - start - 8);
+  for (int i = 0; i < 4; i++) { (*out)[start + i] = static_cast<unsigned char>(len >> (24 - i * 8)); }
+  const unsigned* crc = tables().crc;
+  unsigned c = 0xffffffffu;
+  for (size_t i = start + 4; i < out->size(); i++) { c = crc[(c ^ (*out)[i]) & 0xff] ^ (c >> 8); }
+  put_u32(out, c ^ 0xffffffffu);
+}
+
+
+static size_t begin_chunk(std::vector<unsigned char>* out, const char* type) {
+  size_t start = out->size();
+  put_u32(out, 0);
+  out->insert(out->end(), type, type + 4);
+  return start;
+}
+
+
+/* picks whichever of None, Sub and Up gives the smallest sum of absolute
+** differences, the usual heuristic */
+static void filter_rows(PngEncoder* enc, const unsigned char* rgb, int width, int height) {
+  const int stride = width * 3;
+  enc->filtered.resize(static_cast<size_t>(stride + 1) * height);
+  for (int y = 0; y < height; y++) {
+    const unsigned char* row = rgb + static_cast<size_t>(y) * stride;
+    const unsigned char* prev = y > 0 ? row - stride : NULL;
+    unsigned char* dst = &enc->filtered[static_cast<size_t>(y) * (stride + 1)];
+    long cost_none = 0, cost_sub = 0, cost_up = 0;
+    for (int x = 0; x < stride; x++) {
+      cost_none += std::abs(static_cast<signed char>(row[x]));
+      cost_sub += std::abs(static_cast<signed char>(row[x] - (x >= 3 ? row[x - 3] : 0)));
+      cost_up += std::abs(static_cast<signed char>(row[x] - (prev ? prev[x] : 0)));
+    }
+    if (cost_sub <= cost_up && cost_sub < cost_none) {
+      dst[0] = 1;
+      for (int x = 0; x < stride; x++) { dst[x + 1] = static_cast<unsigned char>(row[x] - (x >= 3 ? row[x - 3] : 0)); }
+    } else if (cost_up < cost_none) {
+      dst[0] = 2;
+      for (int x = 0; x < stride; x++) { dst[x + 1] = static_cast<unsigned char>(row[x] - prev[x]); }
+    } else {
+      dst[0] = 0;
+      std::copy(row, row + stride, dst + 1);
+    }
+  }
+}
+
+
+void png_encode(PngEncoder* enc, const unsigned char* rgb, int width, int height) {
+  static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  std::vector<unsigned char>* out = &enc->out;
+  out->assign(signature, signature + 8);
+
+  size_t chunk = begin_chunk(out, "IHDR");
+  put_u32(out, width);
+  put_u32(out, height);
+  out->push_back(8);  /* bit depth */
+  out->push_back(2);  /* color type: RGB */
+  out->push_back(0);  /* compression, filter, interlace */
+  out->push_back(0);
+  out->push_back(0);
+  end_chunk(out, chunk);
+
+  filter_rows(enc, rgb, width, height);
+  chunk = begin_chunk(out, "IDAT");
+  out->push_back(0x78);  /* zlib header: deflate, 32K window, fastest */
+  out->push_back(0x01);
+  deflate_fixed(enc, enc->filtered.data(), static_cast<int>(enc->filtered.size()));
+  put_u32(out, adler32(enc->filtered.data(), enc->filtered.size()));
+  end_chunk(out, chunk);
+
+  end_chunk(out, begin_chunk(out, "IEND"));
+}
+
+
+bool png_write(PngEncoder* enc, const char* path, const unsigned char* rgb, int width, int height) {
+  png_encode(enc, rgb, width, height);
+  FILE* fp = fopen(path, "wb");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return false;
+  }
+  bool ok = fwrite(enc->out.data(), 1, enc->out.size(), fp) == enc->out.size();
+  ok = fclose(fp) == 0 && ok;
+  if (!ok) { fprintf(stderr, "error writing '%s'\n", path); }
+  return ok;
+}
@@ -0,0 +1,19 @@
+#ifndef PNG_H
+#define PNG_H
+#include <vector>
+
+/* fast 8-bit RGB PNG encoder: per-row filter choice, then a single
+** fixed-Huffman deflate block with a one-probe hash match finder. trades
+** a little size for speed; flat UI images still compress well. the scratch
+** is reused between images, so keep one encoder per thread */
+struct PngEncoder {
+  std::vector<unsigned char> filtered;
+  std::vector<int> head;
+  std::vector<unsigned char> out;
+};
+
+/* encodes into enc->out */
+void png_encode(PngEncoder* enc, const unsigned char* rgb, int width, int height);
+bool png_write(PngEncoder* enc, const char* path, const unsigned char* rgb, int width, int height);
+
+#endif
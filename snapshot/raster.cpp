@@ -0,0 +1,107 @@
+#include <cmath>
+#include "raster.h"
+
+struct Atlas {
+  const unsigned char* pixels;
+  int width, height;
+};
+
+
+static Atlas load_atlas() {
+  Atlas a;
+  a.pixels = batch_atlas_texture(&a.width, &a.height);
+  return a;
+}
+
+
+/* rasters are set up and flushed on several workers at once, so the atlas
+** sits behind a function-local static, which C++ initializes exactly once */
+static const Atlas& shared_atlas() {
+  static const Atlas atlas = load_atlas();
+  return atlas;
+}
+
+
+static mu_Rect intersect(mu_Rect a, mu_Rect b) {
+  int x1 = mu_max(a.x, b.x);
+  int y1 = mu_max(a.y, b.y);
+  int x2 = mu_min(a.x + a.w, b.x + b.w);
+  int y2 = mu_min(a.y + a.h, b.y + b.h);
+  return mu_rect(x1, y1, mu_max(x2 - x1, 0), mu_max(y2 - y1, 0));
+}
+
+
+static void blend_quad(Raster* r, const Atlas& atlas, const float* tex, const float* vert, const unsigned char* color) {
+  const float x0 = vert[0], y0 = vert[1], x1 = vert[6], y1 = vert[7];
+  if (x1 <= x0 || y1 <= y0) { return; }
+  mu_Rect area = intersect(mu_rect(static_cast<int>(x0), static_cast<int>(y0),
+    static_cast<int>(x1 - x0), static_cast<int>(y1 - y0)), r->clip);
+  if (area.w == 0 || area.h == 0) { return; }
+
+  /* texel at pixel centers, as GL_NEAREST samples */
+  const float u0 = tex[0] * atlas.width, v0 = tex[1] * atlas.height;
+  const float du = (tex[6] - tex[0]) * atlas.width / (x1 - x0);
+  const float dv = (tex[7] - tex[1]) * atlas.height / (y1 - y0);
+  const int cr = color[0], cg = color[1], cb = color[2], ca = color[3];
+
+  for (int y = area.y; y < area.y + area.h; y++) {
+    int ty = mu_clamp(static_cast<int>(v0 + (y + 0.5f - y0) * dv), 0, atlas.height - 1);
+    const unsigned char* row = atlas.pixels + ty * atlas.width;
+    unsigned char* dst = &r->pixels[(static_cast<size_t>(y) * r->width + area.x) * 3];
+    for (int x = area.x; x < area.x + area.w; x++, dst += 3) {
+      int tx = mu_clamp(static_cast<int>(u0 + (x + 0.5f - x0) * du), 0, atlas.width - 1);
+      int a = row[tx] * ca;  /* 0 .. 255 * 255 */
+      if (a == 0) { continue; }
+      if (a == 255 * 255) {
+        dst[0] = static_cast<unsigned char>(cr);
+        dst[1] = static_cast<unsigned char>(cg);
+        dst[2] = static_cast<unsigned char>(cb);
+        continue;
+      }
+      int ia = 255 * 255 - a;
+      dst[0] = static_cast<unsigned char>((cr * a + dst[0] * ia + 32512) / 65025);
+      dst[1] = static_cast<unsigned char>((cg * a + dst[1] * ia + 32512) / 65025);
+      dst[2] = static_cast<unsigned char>((cb * a + dst[2] * ia + 32512) / 65025);
+    }
+  }
+}
+
+
+static void flush(Batch* b) {
+  Raster* r = static_cast<Raster*>(b->user);
+  const Atlas& atlas = shared_atlas();
+  for (int i = 0; i < b->count; i++) {
+    blend_quad(r, atlas, b->tex + i * 8, b->vert + i * 8, b->color + i * 16);
+  }
+}
+
+
+static void set_clip(Batch* b, mu_Rect rect) {
+  Raster* r = static_cast<Raster*>(b->user);
+  r->clip = intersect(rect, mu_rect(0, 0, r->width, r->height));
+}
+
+
+void raster_init(Raster* r, int width, int height) {
+  batch_init(&r->batch, flush, set_clip, r);
+  r->width = width;
+  r->height = height;
+  r->pixels.assign(static_cast<size_t>(width) * height * 3, 0);
+  r->clip = mu_rect(0, 0, width, height);
+}
+
+
+void raster_clear(Raster* r, mu_Color color) {
+  for (size_t i = 0; i < r->pixels.size(); i += 3) {
+    r->pixels[i + 0] = color.r;
+    r->pixels[i + 1] = color.g;
+    r->pixels[i + 2] = color.b;
+  }
+  r->clip = mu_rect(0, 0, r->width, r->height);
+}
+
+
+void raster_draw_commands(Raster* r, mu_Context* ctx) {
+  batch_draw_commands(&r->batch, ctx);
+  batch_flush(&r->batch);
+}
@@ -0,0 +1,21 @@
+#ifndef RASTER_H
+#define RASTER_H
+#include <vector>
+#include "batch.h"
+
+/* CPU rasterizer backend: a Batch whose flush blends the quads into an RGB
+** framebuffer, sampling the atlas the same way the GL renderer does
+** (nearest texel, alpha from the atlas times the vertex color). every
+** instance is independent, so one per thread renders in parallel */
+struct Raster {
+  Batch batch;
+  int width, height;
+  std::vector<unsigned char> pixels;  /* width * height * 3, top row first */
+  mu_Rect clip;
+};
+
+void raster_init(Raster* r, int width, int height);
+void raster_clear(Raster* r, mu_Color color);
+void raster_draw_commands(Raster* r, mu_Context* ctx);
+
+#endif
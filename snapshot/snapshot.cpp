@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+extern "C" {
+#include "microui.h"
+}
+#include "batch.h"
+#include "png.h"
+#include "raster.h"
+#include "status_panel.h"
+#include "thread_pool.h"
+
+/* batch thumbnail renderer: builds one status panel per parameter file, each
+** in its own mu_Context on a pool thread, rasterizes it on the CPU and
+** writes a PNG next to the parameter file (or into --out) */
+
+struct Job {
+  std::string in, out;
+  bool ok;
+};
+
+struct Jobs {
+  std::vector<Job> list;
+};
+
+/* everything a thread needs to render, created on first use and reused */
+struct Worker {
+  mu_Context ctx;
+  Raster raster;
+  PngEncoder png;
+  PanelParams params;
+};
+
+static thread_local std::unique_ptr<Worker> worker;
+
+
+static int text_width(mu_Font font, const char* text, int len) {
+  return batch_text_width(text, len);
+}
+
+static int text_height(mu_Font font) {
+  return batch_text_height();
+}
+
+
+static double now_s() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void render_job(void* user, int index) {
+  Job& job = static_cast<Jobs*>(user)->list[index];
+  if (!worker) {
+    worker.reset(new Worker);
+    raster_init(&worker->raster, 0, 0);
+  }
+  Worker* w = worker.get();
+  if (!panel_load(job.in.c_str(), &w->params)) {
+    job.ok = false;
+    return;
+  }
+  mu_init(&w->ctx);
+  w->ctx.text_width = text_width;
+  w->ctx.text_height = text_height;
+  panel_frame(&w->ctx, &w->params);
+
+  if (w->raster.width != w->params.width || w->raster.height != w->params.height) {
+    raster_init(&w->raster, w->params.width, w->params.height);
+  }
+  raster_clear(&w->raster, panel_background());
+  raster_draw_commands(&w->raster, &w->ctx);
+  job.ok = png_write(&w->png, job.out.c_str(), w->raster.pixels.data(), w->raster.width, w->raster.height);
+}
+
+
+static std::string output_path(const std::string& in, const char* dir) {
+  std::string base = in;
+  size_t dot = base.rfind('.');
+  size_t slash = base.find_last_of("/\\");
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) { base.erase(dot); }
+  if (!dir) { return base + ".png"; }
+  if (slash != std::string::npos) { base.erase(0, slash + 1); }
+  return std::string(dir) + "/" + base + ".png";
+}
+
+
+static void usage() {
+  fprintf(stderr,
+    "usage: microui-snapshot [options] PARAMS...\n"
+    "  --threads N  render on N threads (default: one per core)\n"
+    "  --out DIR    write the images into DIR instead of next to each\n"
+    "               parameter file\n"
+    "  --list FILE  read parameter file names from FILE, one per line\n");
+}
+
+
+int main(int argc, char** argv) {
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  const char* out = NULL;
+  Jobs jobs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      out = argv[++i];
+    } else if (arg == "--list" && i + 1 < argc) {
+      FILE* fp = fopen(argv[++i], "r");
+      if (!fp) {
+        fprintf(stderr, "can't open '%s'\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+      char line[1024];
+      while (fgets(line, sizeof(line), fp)) {
+        std::string name = line;
+        while (!name.empty() && (name.back() == '\n' || name.back() == '\r')) { name.pop_back(); }
+        if (!name.empty()) { jobs.list.push_back({ name, "", false }); }
+      }
+      fclose(fp);
+    } else if (arg[0] != '-') {
+      jobs.list.push_back({ arg, "", false });
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (jobs.list.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  for (Job& job : jobs.list) { job.out = output_path(job.in, out); }
+
+  threads = mu_max(threads, 1);
+  tp_Pool* pool = threads > 1 ? tp_create(threads - 1) : NULL;
+  double t0 = now_s();
+  const int count = static_cast<int>(jobs.list.size());
+  if (pool) { tp_run(pool, count, render_job, &jobs); }
+  else { for (int i = 0; i < count; i++) { render_job(&jobs, i); } }
+  double t1 = now_s();
+  tp_destroy(pool);
+
+  int failed = 0;
+  for (const Job& job : jobs.list) { failed += !job.ok; }
+  int done = static_cast<int>(jobs.list.size()) - failed;
+  fprintf(stderr, "%d images in %.3f s on %d threads (%.1f images/s)", done, t1 - t0, threads, done / (t1 - t0));
+  if (failed) { fprintf(stderr, ", %d failed", failed); }
+  fprintf(stderr, "\n");
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
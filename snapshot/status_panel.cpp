@@ -0,0 +1,108 @@
+#include <cstdlib>
+#include <stdio.h>
+#include "status_panel.h"
+
+
+static std::string trim(const std::string& s) {
+  size_t first = s.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) { return ""; }
+  size_t last = s.find_last_not_of(" \t\r\n");
+  return s.substr(first, last - first + 1);
+}
+
+
+bool panel_load(const char* path, PanelParams* params) {
+  FILE* fp = fopen(path, "r");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return false;
+  }
+  *params = PanelParams();
+  params->title = "Status";
+  params->status = "ok";
+  params->cpu = params->mem = 0;
+  params->width = 320;
+  params->height = 200;
+
+  char line[512];
+  int lineno = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), fp)) {
+    lineno++;
+    std::string s = trim(line);
+    if (s.empty() || s[0] == '#') { continue; }
+    size_t eq = s.find('=');
+    if (eq == std::string::npos) {
+      fprintf(stderr, "%s:%d: expected 'key = value'\n", path, lineno);
+      ok = false;
+      break;
+    }
+    std::string key = trim(s.substr(0, eq));
+    std::string value = trim(s.substr(eq + 1));
+    if (key == "title") { params->title = value; }
+    else if (key == "status") { params->status = value; }
+    else if (key == "cpu") { params->cpu = mu_clamp(atoi(value.c_str()), 0, 100); }
+    else if (key == "mem") { params->mem = mu_clamp(atoi(value.c_str()), 0, 100); }
+    else if (key == "width") { params->width = mu_clamp(atoi(value.c_str()), 64, 4096); }
+    else if (key == "height") { params->height = mu_clamp(atoi(value.c_str()), 64, 4096); }
+    else if (key == "log") { params->log.push_back(value); }
+    else {
+      fprintf(stderr, "%s:%d: unknown key '%s'\n", path, lineno, key.c_str());
+      ok = false;
+      break;
+    }
+  }
+  fclose(fp);
+  return ok;
+}
+
+
+static mu_Color status_color(const std::string& status) {
+  if (status == "ok") { return mu_color(70, 170, 90, 255); }
+  if (status == "warn") { return mu_color(220, 170, 50, 255); }
+  return mu_color(200, 60, 60, 255);
+}
+
+
+static void meter(mu_Context* ctx, const char* label, int percent) {
+  char buf[32];
+  mu_label(ctx, label);
+  mu_Rect r = mu_layout_next(ctx);
+  mu_draw_rect(ctx, r, ctx->style->colors[MU_COLOR_BASE]);
+  mu_Color fill = percent >= 90 ? status_color("error") : percent >= 70 ? status_color("warn") : status_color("ok");
+  mu_draw_rect(ctx, mu_rect(r.x, r.y, r.w * percent / 100, r.h), fill);
+  snprintf(buf, sizeof(buf), "%d%%", percent);
+  mu_draw_control_text(ctx, buf, r, MU_COLOR_TEXT, MU_OPT_ALIGNCENTER);
+}
+
+
+void panel_frame(mu_Context* ctx, const PanelParams* params) {
+  mu_begin(ctx);
+  const int opt = MU_OPT_NOCLOSE | MU_OPT_NORESIZE | MU_OPT_NOSCROLL;
+  if (mu_begin_window_ex(ctx, params->title.c_str(), mu_rect(0, 0, params->width, params->height), opt)) {
+    const int widths[] = { 50, -1 };
+    mu_layout_row(ctx, 2, widths, 0);
+    mu_label(ctx, "Status:");
+    mu_Rect r = mu_layout_next(ctx);
+    mu_draw_rect(ctx, mu_rect(r.x, r.y + 4, r.h - 8, r.h - 8), status_color(params->status));
+    r.x += r.h;
+    r.w -= r.h;
+    mu_draw_control_text(ctx, params->status.c_str(), r, MU_COLOR_TEXT, 0);
+    meter(ctx, "CPU:", params->cpu);
+    meter(ctx, "Memory:", params->mem);
+
+    const int full[] = { -1 };
+    mu_layout_row(ctx, 1, full, -1);
+    mu_begin_panel_ex(ctx, "Log", MU_OPT_NOSCROLL);
+    mu_layout_row(ctx, 1, full, 0);
+    for (const std::string& line : params->log) { mu_text(ctx, line.c_str()); }
+    mu_end_panel(ctx);
+    mu_end_window(ctx);
+  }
+  mu_end(ctx);
+}
+
+
+mu_Color panel_background(void) {
+  return mu_color(40, 40, 40, 255);
+}
@@ -0,0 +1,27 @@
+#ifndef STATUS_PANEL_H
+#define STATUS_PANEL_H
+#include <string>
+#include <vector>
+extern "C" {
+#include "microui.h"
+}
+
+/* the status-panel thumbnail layout, driven by a parameter file of
+** `key = value` lines:
+**   title, status (ok|warn|error), cpu, mem (percent), width, height
+** and any number of `log` lines. '#' starts a comment. keeps no state of its
+** own, so panels can be built on several threads at once */
+struct PanelParams {
+  std::string title;
+  std::string status;
+  int cpu, mem;
+  int width, height;
+  std::vector<std::string> log;
+};
+
+bool panel_load(const char* path, PanelParams* params);
+/* builds one frame: mu_begin() .. mu_end() */
+void panel_frame(mu_Context* ctx, const PanelParams* params);
+mu_Color panel_background(void);
+
+#endif
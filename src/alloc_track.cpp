@@ -0,0 +1,188 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include "alloc_track.h"
+
+static const char* scope_names[AT_SCOPE_MAX] = { "other", "input", "ui", "render", "gl" };
+
+
+const char* at_scope_name(int scope) {
+  return scope >= 0 && scope < AT_SCOPE_MAX ? scope_names[scope] : "?";
+}
+
+
+long long at_total(const at_Frame* f, int critical_only) {
+  long long n = 0;
+  for (int s = 0; s < AT_SCOPE_MAX; s++) {
+    if (critical_only && s != AT_UI && s != AT_RENDER && s != AT_GL) { continue; }
+    for (int k = 0; k < AT_KIND_MAX; k++) { n += f->count[s][k]; }
+  }
+  return n;
+}
+
+
+#ifdef MU_ALLOC_TRACK
+/* the hooks may run before main() and on any thread, so only trivially
+** initialized state: atomics and a plain thread_local */
+static std::atomic<long long> counts[AT_SCOPE_MAX][AT_KIND_MAX];
+static std::atomic<long long> bytes[AT_SCOPE_MAX];
+static thread_local int current_scope;
+
+
+static void count(int kind, size_t size) {
+  counts[current_scope][kind].fetch_add(1, std::memory_order_relaxed);
+  bytes[current_scope].fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+}
+
+
+int at_scope_enter(int scope) {
+  int prev = current_scope;
+  current_scope = scope;
+  return prev;
+}
+
+
+void at_scope_leave(int prev) {
+  current_scope = prev;
+}
+
+
+void at_frame(at_Frame* out) {
+  for (int s = 0; s < AT_SCOPE_MAX; s++) {
+    for (int k = 0; k < AT_KIND_MAX; k++) {
+      out->count[s][k] = counts[s][k].exchange(0, std::memory_order_relaxed);
+    }
+    out->bytes[s] = bytes[s].exchange(0, std::memory_order_relaxed);
+  }
+}
+
+
+#ifdef __GLIBC__
+/* interpose the C allocator; glibc exports its implementation under these
+** names. elsewhere only operator new is counted */
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void  __libc_free(void* p);
+
+void* malloc(size_t size) {
+  count(AT_MALLOC, size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+  count(AT_MALLOC, n * size);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) {
+  count(AT_MALLOC, size);
+  return __libc_realloc(p, size);
+}
+
+void free(void* p) {
+  __libc_free(p);
+}
+
+/* the aligned entry points; left alone they would go straight to glibc's
+** own implementation and never be counted */
+void* __libc_memalign(size_t align, size_t size);
+
+void* memalign(size_t align, size_t size) {
+  count(AT_MALLOC, size);
+  return __libc_memalign(align, size);
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+  count(AT_MALLOC, size);
+  return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** out, size_t align, size_t size) {
+  if (align % sizeof(void*) != 0 || (align & (align - 1)) != 0) { return EINVAL; }
+  count(AT_MALLOC, size);
+  void* p = __libc_memalign(align, size);
+  if (!p) { return ENOMEM; }
+  *out = p;
+  return 0;
+}
+}
+#define raw_malloc __libc_malloc
+#define raw_free   __libc_free
+#define raw_aligned_malloc(align, size) __libc_memalign(align, size)
+#define raw_aligned_free __libc_free
+#elif defined(_WIN32)
+#define raw_malloc std::malloc
+#define raw_free   std::free
+#define raw_aligned_malloc(align, size) _aligned_malloc(size, align)
+#define raw_aligned_free _aligned_free
+#else
+#define raw_malloc std::malloc
+#define raw_free   std::free
+/* aligned_alloc() wants the size to be a multiple of the alignment */
+#define raw_aligned_malloc(align, size) std::aligned_alloc(align, ((size) + (align) - 1) / (align) * (align))
+#define raw_aligned_free std::free
+#endif
+
+
+void* operator new(size_t size) {
+  count(AT_NEW, size);
+  void* p = raw_malloc(size ? size : 1);
+  if (!p) { throw std::bad_alloc(); }
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  count(AT_NEW, size);
+  return raw_malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { raw_free(p); }
+void operator delete[](void* p) noexcept { raw_free(p); }
+void operator delete(void* p, size_t) noexcept { raw_free(p); }
+void operator delete[](void* p, size_t) noexcept { raw_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { raw_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { raw_free(p); }
+
+
+/* over-aligned types (alignas beyond the default new alignment) */
+void* operator new(size_t size, std::align_val_t align) {
+  count(AT_NEW, size);
+  void* p = raw_aligned_malloc(static_cast<size_t>(align), size ? size : 1);
+  if (!p) { throw std::bad_alloc(); }
+  return p;
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+  return operator new(size, align);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  count(AT_NEW, size);
+  return raw_aligned_malloc(static_cast<size_t>(align), size ? size : 1);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t& tag) noexcept {
+  return operator new(size, align, tag);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { raw_aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { raw_aligned_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { raw_aligned_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { raw_aligned_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { raw_aligned_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { raw_aligned_free(p); }
+#endif
@@ -0,0 +1,48 @@
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+/* allocation tracking, built with MU_ALLOC_TRACK: replaces operator new
+** (aligned forms included) and, on glibc, malloc/calloc/realloc and the
+** memalign family so that GL driver allocations are seen too. every
+** allocation is attributed to the calling thread's current scope. without
+** MU_ALLOC_TRACK scopes compile to nothing and at_frame() reports zeros */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum { AT_OTHER, AT_INPUT, AT_UI, AT_RENDER, AT_GL, AT_SCOPE_MAX };
+enum { AT_MALLOC, AT_NEW, AT_KIND_MAX };
+
+typedef struct {
+  long long count[AT_SCOPE_MAX][AT_KIND_MAX];
+  long long bytes[AT_SCOPE_MAX];
+} at_Frame;
+
+const char* at_scope_name(int scope);
+/* total allocations in `f`, optionally only the frame-critical scopes (UI,
+** render and GL) */
+long long at_total(const at_Frame* f, int critical_only);
+
+#ifdef __cplusplus
+}
+
+/* scopes and at_frame() are C++ only */
+#ifdef MU_ALLOC_TRACK
+ int at_scope_enter(int scope);
+void at_scope_leave(int prev);
+struct AllocScope {
+  int prev;
+  explicit AllocScope(int scope) : prev(at_scope_enter(scope)) {}
+  ~AllocScope() { at_scope_leave(prev); }
+};
+#define ALLOC_SCOPE(scope) AllocScope alloc_scope_(scope)
+
+/* counts since the previous call */
+void at_frame(at_Frame* out);
+#else
+#define ALLOC_SCOPE(scope) ((void) 0)
+inline void at_frame(at_Frame* out) { *out = at_Frame(); }
+#endif
+#endif
+
+#endif
@@ -0,0 +1,319 @@
+#include <cstring>
+#include "alloc_track.h"
+#include "batch.h"
+#include "cmdlist.h"
+#include "perf_stats.h"
+#include "thread_pool.h"
+#include "trace.h"
+
+#include "atlas.inl"
+
+/* frames smaller than this are always translated on the calling thread */
+#define PARALLEL_MIN_COMMANDS 1024
+/* a clip-free run of commands is split into jobs of at most this size */
+#define RANGE_MAX_COMMANDS    512
+
+static tp_Pool* pool;
+
+
+void batch_init(Batch* batch, void (*flush)(Batch*), void (*clip)(Batch*, mu_Rect), void* user) {
+  batch->count = 0;
+  batch->flush = flush;
+  batch->clip = clip;
+  batch->user = user;
+}
+
+
+void batch_flush(Batch* batch) {
+  if (batch->count == 0) { return; }
+  ps_count_flush(batch->count);
+  batch->flush(batch);
+  batch->count = 0;
+}
+
+
+static void write_quad(float* tex, float* vert, unsigned char* col, mu_Rect dst, mu_Rect src, mu_Color color) {
+  /* update texture buffer */
+  float x = src.x / (float) ATLAS_WIDTH;
+  float y = src.y / (float) ATLAS_HEIGHT;
+  float w = src.w / (float) ATLAS_WIDTH;
+  float h = src.h / (float) ATLAS_HEIGHT;
+  tex[0] = x;
+  tex[1] = y;
+  tex[2] = x + w;
+  tex[3] = y;
+  tex[4] = x;
+  tex[5] = y + h;
+  tex[6] = x + w;
+  tex[7] = y + h;
+
+  /* update vertex buffer */
+  vert[0] = static_cast<float>(dst.x);
+  vert[1] = static_cast<float>(dst.y);
+  vert[2] = static_cast<float>(dst.x + dst.w);
+  vert[3] = static_cast<float>(dst.y);
+  vert[4] = static_cast<float>(dst.x);
+  vert[5] = static_cast<float>(dst.y + dst.h);
+  vert[6] = static_cast<float>(dst.x + dst.w);
+  vert[7] = static_cast<float>(dst.y + dst.h);
+
+  /* update color buffer */
+  std::memcpy(col +  0, &color, 4);
+  std::memcpy(col +  4, &color, 4);
+  std::memcpy(col +  8, &color, 4);
+  std::memcpy(col + 12, &color, 4);
+}
+
+
+void batch_push_quad(Batch* batch, mu_Rect dst, mu_Rect src, mu_Color color) {
+  if (batch->count == BATCH_SIZE) { batch_flush(batch); }
+
+  int texvert_idx = batch->count *  8;
+  int   color_idx = batch->count * 16;
+  batch->count++;
+
+  write_quad(batch->tex + texvert_idx, batch->vert + texvert_idx, batch->color + color_idx, dst, src, color);
+}
+
+
+template <typename PushQuad>
+static void emit_text(PushQuad&& push, const char *text, mu_Vec2 pos, mu_Color color) {
+  mu_Rect dst = { pos.x, pos.y, 0, 0 };
+  for (const char *p = text; *p; p++) {
+    if ((*p & 0xc0) == 0x80) { continue; }
+    int chr = mu_min((unsigned char) *p, 127);
+    mu_Rect src = atlas[ATLAS_FONT + chr];
+    dst.w = src.w;
+    dst.h = src.h;
+    push(dst, src, color);
+    dst.x += dst.w;
+  }
+}
+
+
+template <typename PushQuad>
+static void emit_icon(PushQuad&& push, int id, mu_Rect rect, mu_Color color) {
+  mu_Rect src = atlas[id];
+  int x = rect.x + (rect.w - src.w) / 2;
+  int y = rect.y + (rect.h - src.h) / 2;
+  push(mu_rect(x, y, src.w, src.h), src, color);
+}
+
+
+template <typename PushQuad>
+static void emit_rect(PushQuad&& push, mu_Rect rect, mu_Color color) {
+  if (rect.w > 0 && rect.h > 0) { push(rect, atlas[ATLAS_WHITE], color); }
+}
+
+
+/* the edges in mu_draw_box() order */
+template <typename PushQuad>
+static void emit_box(PushQuad&& push, mu_Rect r, mu_Color color) {
+  emit_rect(push, mu_rect(r.x + 1, r.y, r.w - 2, 1), color);
+  emit_rect(push, mu_rect(r.x + 1, r.y + r.h - 1, r.w - 2, 1), color);
+  emit_rect(push, mu_rect(r.x, r.y, 1, r.h), color);
+  emit_rect(push, mu_rect(r.x + r.w - 1, r.y, 1, r.h), color);
+}
+
+
+template <typename PushQuad>
+static void emit_frame(PushQuad&& push, mu_Rect rect, mu_Color color, mu_Color border) {
+  mu_Rect outer = mu_rect(rect.x - 1, rect.y - 1, rect.w + 2, rect.h + 2);
+  if (color.a == 255 && rect.w > 0 && rect.h > 0) {
+    /* an opaque fill hides the middle of the border quad */
+    push(outer, atlas[ATLAS_WHITE], border);
+    push(rect, atlas[ATLAS_WHITE], color);
+    return;
+  }
+  emit_rect(push, rect, color);
+  emit_box(push, outer, border);
+}
+
+
+template <typename PushQuad>
+static void emit_command(PushQuad&& push, const mu_Command* cmd) {
+  switch (cmd->type) {
+  case MU_COMMAND_TEXT: emit_text(push, cmd->text.str, cmd->text.pos, cmd->text.color); break;
+  case MU_COMMAND_RECT: push(cmd->rect.rect, atlas[ATLAS_WHITE], cmd->rect.color); break;
+  case MU_COMMAND_ICON: emit_icon(push, cmd->icon.id, cmd->icon.rect, cmd->icon.color); break;
+  case MU_COMMAND_BOX: emit_box(push, cmd->box.rect, cmd->box.color); break;
+  case MU_COMMAND_FRAME: emit_frame(push, cmd->frame.rect, cmd->frame.color, cmd->frame.border); break;
+  }
+}
+
+
+int batch_command_quads(const mu_Command* cmd) {
+  int n = 0;
+  emit_command([&n](mu_Rect, mu_Rect, mu_Color) { n++; }, cmd);
+  return n;
+}
+
+
+void batch_draw_rect(Batch* batch, mu_Rect rect, mu_Color color) {
+  batch_push_quad(batch, rect, atlas[ATLAS_WHITE], color);
+}
+
+
+void batch_draw_text(Batch* batch, const char *text, mu_Vec2 pos, mu_Color color) {
+  emit_text([batch](mu_Rect dst, mu_Rect src, mu_Color c) { batch_push_quad(batch, dst, src, c); }, text, pos, color);
+}
+
+
+void batch_draw_icon(Batch* batch, int id, mu_Rect rect, mu_Color color) {
+  emit_icon([batch](mu_Rect dst, mu_Rect src, mu_Color c) { batch_push_quad(batch, dst, src, c); }, id, rect, color);
+}
+
+
+void batch_set_clip(Batch* batch, mu_Rect rect) {
+  batch_flush(batch);
+  ps_count_clip();
+  batch->clip(batch, rect);
+}
+
+
+void batch_set_workers(int count) {
+  tp_destroy(pool);
+  pool = count > 1 ? tp_create(count - 1) : NULL;
+}
+
+
+static void generate_range(void* user, int job) {
+  TRACE_ZONE("generate range");
+  ALLOC_SCOPE(AT_RENDER);
+  BatchRange& r = static_cast<Batch*>(user)->ranges[job];
+  const std::vector<const mu_Command*>& commands = static_cast<Batch*>(user)->commands;
+  r.count = 0;
+  auto push = [&r](mu_Rect dst, mu_Rect src, mu_Color color) {
+    if (static_cast<size_t>(r.count) * 8 == r.vert.size()) {
+      size_t quads = mu_max(static_cast<size_t>(r.count) * 2, static_cast<size_t>(64));
+      r.tex.resize(quads * 8);
+      r.vert.resize(quads * 8);
+      r.color.resize(quads * 16);
+    }
+    write_quad(&r.tex[r.count * 8], &r.vert[r.count * 8], &r.color[r.count * 16], dst, src, color);
+    r.count++;
+  };
+  for (int i = r.first; i < r.last; i++) {
+    emit_command(push, commands[i]);
+  }
+}
+
+
+/* copies a range's quads into the batch, flushing exactly where
+** batch_push_quad() would, so the output matches the serial path byte for
+** byte */
+static void append_range(Batch* batch, const BatchRange& r) {
+  int i = 0;
+  while (i < r.count) {
+    if (batch->count == BATCH_SIZE) { batch_flush(batch); }
+    int n = mu_min(r.count - i, BATCH_SIZE - batch->count);
+    std::memcpy(batch->tex + batch->count * 8, &r.tex[i * 8], sizeof(float) * n * 8);
+    std::memcpy(batch->vert + batch->count * 8, &r.vert[i * 8], sizeof(float) * n * 8);
+    std::memcpy(batch->color + batch->count * 16, &r.color[i * 16], n * 16);
+    batch->count += n;
+    i += n;
+  }
+}
+
+
+static void draw_commands_parallel(Batch* batch) {
+  std::vector<const mu_Command*>& commands = batch->commands;
+  std::vector<BatchRange>& ranges = batch->ranges;
+
+  /* split at clip commands, and chunk long clip-free runs */
+  int nranges = 0;
+  const int n = static_cast<int>(commands.size());
+  for (int i = 0; i < n; i++) {
+    const bool is_clip = commands[i]->type == MU_COMMAND_CLIP;
+    if (i == 0 || is_clip || i - ranges[nranges - 1].first >= RANGE_MAX_COMMANDS) {
+      if (nranges == static_cast<int>(ranges.size())) { ranges.emplace_back(); }
+      BatchRange& r = ranges[nranges++];
+      r.first = is_clip ? i + 1 : i;
+      r.clip = is_clip ? i : -1;
+      r.count = 0;
+    }
+    ranges[nranges - 1].last = i + 1;
+  }
+
+  tp_run(pool, nranges, generate_range, batch);
+
+  /* stitch in the original order */
+  for (int i = 0; i < nranges; i++) {
+    const BatchRange& r = ranges[i];
+    if (r.clip >= 0) { batch_set_clip(batch, commands[r.clip]->clip.rect); }
+    append_range(batch, r);
+  }
+}
+
+
+static void translate_commands(Batch* batch) {
+  TRACE_ZONE("render commands");
+  if (pool && batch->commands.size() >= PARALLEL_MIN_COMMANDS) {
+    draw_commands_parallel(batch);
+    return;
+  }
+  auto push = [batch](mu_Rect dst, mu_Rect src, mu_Color color) { batch_push_quad(batch, dst, src, color); };
+  for (const mu_Command* c : batch->commands) {
+    if (c->type == MU_COMMAND_CLIP) { batch_set_clip(batch, c->clip.rect); }
+    else { emit_command(push, c); }
+  }
+}
+
+
+void batch_draw_commands(Batch* batch, mu_Context* ctx) {
+  batch->commands.clear();
+  mu_Command* cmd = NULL;
+  while (mu_next_command(ctx, &cmd)) { batch->commands.push_back(cmd); }
+  translate_commands(batch);
+}
+
+
+void batch_draw_command_list(Batch* batch, const char* data, int size) {
+  batch->commands.clear();
+  const mu_Command* cmd = NULL;
+  while (cmdlist_next(data, size, &cmd)) { batch->commands.push_back(cmd); }
+  translate_commands(batch);
+}
+
+
+const unsigned* batch_indices(void) {
+  /* the index pattern only depends on the quad slot, so build it once */
+  static const std::vector<unsigned> indices = [] {
+    std::vector<unsigned> res(BATCH_SIZE * 6);
+    for (unsigned i = 0; i < BATCH_SIZE; i++) {
+      unsigned element_idx = i * 4;
+      unsigned   index_idx = i * 6;
+      res[index_idx + 0] = element_idx + 0;
+      res[index_idx + 1] = element_idx + 1;
+      res[index_idx + 2] = element_idx + 2;
+      res[index_idx + 3] = element_idx + 2;
+      res[index_idx + 4] = element_idx + 3;
+      res[index_idx + 5] = element_idx + 1;
+    }
+    return res;
+  }();
+  return indices.data();
+}
+
+
+const unsigned char* batch_atlas_texture(int* width, int* height) {
+  *width = ATLAS_WIDTH;
+  *height = ATLAS_HEIGHT;
+  return atlas_texture;
+}
+
+
+int batch_text_width(const char *text, int len) {
+  int res = 0;
+  for (const char *p = text; *p && len--; p++) {
+    if ((*p & 0xc0) == 0x80) { continue; }
+    int chr = mu_min((unsigned char) *p, 127);
+    res += atlas[ATLAS_FONT + chr].w;
+  }
+  return res;
+}
+
+
+int batch_text_height(void) {
+  return 18;
+}
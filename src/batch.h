@@ -0,0 +1,59 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include <vector>
+extern "C" {
+#include "microui.h"
+}
+
+#define BATCH_SIZE 16384
+
+/* parallel translation: one range per clip change (or per chunk of commands),
+** each generating into its own slice that is stitched in order afterwards */
+struct BatchRange {
+  int first, last;
+  int clip;
+  std::vector<float> tex, vert;
+  std::vector<unsigned char> color;
+  int count;
+};
+
+/* CPU side of the renderer: turns microui commands into textured quads.
+** the backend's `flush` consumes the buffers whenever they fill up, before
+** a clip change and at the end of the frame; `clip` applies a clip rect */
+struct Batch {
+  float tex[BATCH_SIZE * 8];
+  float vert[BATCH_SIZE * 8];
+  unsigned char color[BATCH_SIZE * 16];
+  int count;
+  void (*flush)(Batch* batch);
+  void (*clip)(Batch* batch, mu_Rect rect);
+  void* user;
+  /* scratch reused by batch_draw_commands() */
+  std::vector<const mu_Command*> commands;
+  std::vector<BatchRange> ranges;
+};
+
+void batch_init(Batch* batch, void (*flush)(Batch*), void (*clip)(Batch*, mu_Rect), void* user);
+void batch_flush(Batch* batch);
+void batch_push_quad(Batch* batch, mu_Rect dst, mu_Rect src, mu_Color color);
+void batch_draw_rect(Batch* batch, mu_Rect rect, mu_Color color);
+void batch_draw_text(Batch* batch, const char *text, mu_Vec2 pos, mu_Color color);
+void batch_draw_icon(Batch* batch, int id, mu_Rect rect, mu_Color color);
+void batch_set_clip(Batch* batch, mu_Rect rect);
+/* quads a drawing command translates into; 0 for clips and jumps */
+int batch_command_quads(const mu_Command* cmd);
+/* translates the whole command list of a finished frame */
+void batch_draw_commands(Batch* batch, mu_Context* ctx);
+/* same for a list produced by cmdlist_linearize() */
+void batch_draw_command_list(Batch* batch, const char* data, int size);
+/* number of threads used to translate large command lists; 0 or 1 translates
+** serially. the pool is shared, so only one batch may translate at a time */
+void batch_set_workers(int count);
+
+/* the index pattern of a full buffer, BATCH_SIZE * 6 entries */
+const unsigned* batch_indices(void);
+const unsigned char* batch_atlas_texture(int* width, int* height);
+ int batch_text_width(const char *text, int len);
+ int batch_text_height(void);
+
+#endif
@@ -0,0 +1,195 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+#include "capture.h"
+#include "cmdlist.h"
+
+/* layout:
+**   CapHeader
+**   per frame: CapFrame, then `size` bytes of commands
+**   index:     one uint64 file offset per frame, then CapFooter */
+/* 2 added box and frame commands; version 1 files still read */
+#define CAP_VERSION 2
+
+struct CapHeader {
+  char magic[8];
+  uint32_t version;
+  uint16_t pointer_size;
+  uint16_t command_size;
+};
+
+struct CapFrame {
+  uint32_t size;
+  mu_Color clear;
+};
+
+struct CapFooter {
+  uint32_t frames;
+  char magic[4];
+};
+
+static const char header_magic[8] = { 'M', 'U', 'C', 'A', 'P', 'T', 'U', 'R' };
+static const char footer_magic[4] = { 'I', 'N', 'D', 'X' };
+
+static FILE* capture_fp;
+static std::vector<char> scratch;
+static std::vector<uint64_t> offsets;
+
+
+static CapHeader make_header() {
+  CapHeader h;
+  memcpy(h.magic, header_magic, sizeof(h.magic));
+  h.version = CAP_VERSION;
+  h.pointer_size = sizeof(void*);
+  h.command_size = sizeof(mu_Command);
+  return h;
+}
+
+
+int cap_open(const char* path) {
+  cap_close();
+  capture_fp = fopen(path, "wb");
+  if (!capture_fp) {
+    fprintf(stderr, "can't open '%s' for capture\n", path);
+    return 0;
+  }
+  CapHeader h = make_header();
+  fwrite(&h, sizeof(h), 1, capture_fp);
+  scratch.resize(MU_COMMANDLIST_SIZE);
+  offsets.clear();
+  return 1;
+}
+
+
+void cap_frame(mu_Context* ctx, mu_Color clear) {
+  if (!capture_fp) { return; }
+  CapFrame f;
+  f.size = cmdlist_linearize(ctx, scratch.data(), static_cast<int>(scratch.size()));
+  f.clear = clear;
+  offsets.push_back(ftell(capture_fp));
+  fwrite(&f, sizeof(f), 1, capture_fp);
+  fwrite(scratch.data(), 1, f.size, capture_fp);
+}
+
+
+void cap_close(void) {
+  if (!capture_fp) { return; }
+  CapFooter footer;
+  footer.frames = static_cast<uint32_t>(offsets.size());
+  memcpy(footer.magic, footer_magic, sizeof(footer.magic));
+  fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), capture_fp);
+  fwrite(&footer, sizeof(footer), 1, capture_fp);
+  fclose(capture_fp);
+  capture_fp = NULL;
+}
+
+
+struct cap_Reader {
+  std::vector<char> data;
+  std::vector<uint64_t> offsets;
+};
+
+
+/* checks that frame data at `pos` fits before `end` and holds a well-formed
+** command list, so replay can iterate it blindly */
+static bool valid_frame(const cap_Reader* r, size_t pos, size_t end) {
+  CapFrame f;
+  if (pos < sizeof(CapHeader) || pos + sizeof(f) > end) { return false; }
+  memcpy(&f, &r->data[pos], sizeof(f));
+  if (f.size > end - pos - sizeof(f)) { return false; }
+  const char* data = &r->data[pos + sizeof(f)];
+  for (size_t i = 0; i < f.size;) {
+    mu_BaseCommand base;
+    if (f.size - i < sizeof(base)) { return false; }
+    memcpy(&base, data + i, sizeof(base));
+    if (base.type <= MU_COMMAND_JUMP || base.type >= MU_COMMAND_MAX) { return false; }
+    if (base.size < static_cast<int>(sizeof(base)) || static_cast<size_t>(base.size) > f.size - i) { return false; }
+    i += base.size;
+  }
+  return true;
+}
+
+
+/* walks the frames from the start; used when the index is missing */
+static void scan_frames(cap_Reader* r, size_t end) {
+  r->offsets.clear();
+  size_t pos = sizeof(CapHeader);
+  while (valid_frame(r, pos, end)) {
+    CapFrame f;
+    memcpy(&f, &r->data[pos], sizeof(f));
+    r->offsets.push_back(pos);
+    pos += sizeof(f) + f.size;
+  }
+}
+
+
+static bool read_index(cap_Reader* r) {
+  const size_t size = r->data.size();
+  if (size < sizeof(CapHeader) + sizeof(CapFooter)) { return false; }
+  CapFooter footer;
+  memcpy(&footer, &r->data[size - sizeof(footer)], sizeof(footer));
+  if (memcmp(footer.magic, footer_magic, sizeof(footer.magic)) != 0) { return false; }
+  size_t index_size = static_cast<size_t>(footer.frames) * sizeof(uint64_t);
+  if (index_size > size - sizeof(CapHeader) - sizeof(footer)) { return false; }
+  r->offsets.resize(footer.frames);
+  memcpy(r->offsets.data(), &r->data[size - sizeof(footer) - index_size], index_size);
+  size_t frames_end = size - sizeof(footer) - index_size;
+  for (uint64_t off : r->offsets) {
+    if (!valid_frame(r, off, frames_end)) { return false; }
+  }
+  return true;
+}
+
+
+cap_Reader* cap_reader_open(const char* path) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return NULL;
+  }
+  cap_Reader* r = new cap_Reader();
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) { r->data.insert(r->data.end(), buf, buf + n); }
+  fclose(fp);
+
+  CapHeader expect = make_header(), h;
+  if (r->data.size() < sizeof(h)) { memset(&h, 0, sizeof(h)); }
+  else { memcpy(&h, r->data.data(), sizeof(h)); }
+  if (memcmp(h.magic, expect.magic, sizeof(h.magic)) != 0 || h.version < 1 || h.version > expect.version) {
+    fprintf(stderr, "'%s' is not a command capture\n", path);
+    delete r;
+    return NULL;
+  }
+  if (h.pointer_size != expect.pointer_size || h.command_size != expect.command_size) {
+    fprintf(stderr, "'%s' was captured by a build with a different mu_Command layout\n", path);
+    delete r;
+    return NULL;
+  }
+  if (!read_index(r)) {
+    fprintf(stderr, "'%s' has no frame index, scanning\n", path);
+    scan_frames(r, r->data.size());
+  }
+  return r;
+}
+
+
+void cap_reader_close(cap_Reader* reader) {
+  delete reader;
+}
+
+
+int cap_reader_frame_count(const cap_Reader* reader) {
+  return static_cast<int>(reader->offsets.size());
+}
+
+
+void cap_reader_frame(const cap_Reader* reader, int index, const char** data, int* size, mu_Color* clear) {
+  CapFrame f;
+  const char* p = &reader->data[reader->offsets[index]];
+  memcpy(&f, p, sizeof(f));
+  *data = p + sizeof(f);
+  *size = static_cast<int>(f.size);
+  *clear = f.clear;
+}
@@ -0,0 +1,25 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+extern "C" {
+#include "microui.h"
+}
+
+/* command-list capture: every frame's linearized command list (see
+** cmdlist_linearize()) plus its clear color, streamed to a file. a frame
+** index is appended on close; a file cut short by a crash is re-indexed by
+** scanning the frames. captures are only portable between builds with the
+** same mu_Command layout, which the header records */
+ int cap_open(const char* path);
+void cap_frame(mu_Context* ctx, mu_Color clear);
+void cap_close(void);
+
+typedef struct cap_Reader cap_Reader;
+
+/* loads a whole capture into memory so replay does no I/O */
+cap_Reader* cap_reader_open(const char* path);
+void cap_reader_close(cap_Reader* reader);
+ int cap_reader_frame_count(const cap_Reader* reader);
+/* the commands of frame `index`, iterable with cmdlist_next() */
+void cap_reader_frame(const cap_Reader* reader, int index, const char** data, int* size, mu_Color* clear);
+
+#endif
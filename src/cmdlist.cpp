@@ -0,0 +1,22 @@
+#include <cstring>
+#include <assert.h>
+#include "cmdlist.h"
+
+int cmdlist_linearize(mu_Context* ctx, char* dst, int capacity) {
+  int size = 0;
+  mu_Command* cmd = NULL;
+  while (mu_next_command(ctx, &cmd)) {
+    assert(size + cmd->base.size <= capacity);
+    std::memcpy(dst + size, cmd, cmd->base.size);
+    size += cmd->base.size;
+  }
+  return size;
+}
+
+
+int cmdlist_next(const char* data, int size, const mu_Command** cmd) {
+  const char* p = *cmd ? reinterpret_cast<const char*>(*cmd) + (*cmd)->base.size : data;
+  if (p >= data + size) { return 0; }
+  *cmd = reinterpret_cast<const mu_Command*>(p);
+  return 1;
+}
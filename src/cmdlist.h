@@ -0,0 +1,13 @@
+#ifndef CMDLIST_H
+#define CMDLIST_H
+extern "C" {
+#include "microui.h"
+}
+
+/* a frame's commands copied in draw order with the jumps resolved, so the
+** result can outlive the mu_Context frame it came from */
+ int cmdlist_linearize(mu_Context* ctx, char* dst, int capacity);
+/* iterates a linearized list; pass *cmd = NULL to start */
+ int cmdlist_next(const char* data, int size, const mu_Command** cmd);
+
+#endif
@@ -0,0 +1,242 @@
+#include <cstdint>
+#include <cstring>
+#include <stdio.h>
+#include "demo.h"
+#include "perf_stats.h"
+
+/* the state behind process_frame() and demo_background() */
+static DemoState default_state = [] {
+  DemoState d;
+  demo_init(&d);
+  return d;
+}();
+
+void demo_init(DemoState* d) {
+  d->logbuf[0] = '\0';
+  d->logbuf_updated = 0;
+  d->log_version = 0;
+  d->bg[0] = 90;
+  d->bg[1] = 95;
+  d->bg[2] = 100;
+  d->checks[0] = 1;
+  d->checks[1] = 0;
+  d->checks[2] = 1;
+  d->input[0] = '\0';
+  d->slider_tmp = 0;
+}
+
+static void write_log(DemoState* d, const char* text) {
+  size_t len = strlen(d->logbuf);
+  snprintf(d->logbuf + len, sizeof(d->logbuf) - len, "%s%s", len ? "\n" : "", text);
+  d->logbuf_updated = 1;
+  d->log_version++;
+}
+
+static void test_window(mu_Context* ctx, DemoState* d) {
+  /* do window */
+  if (mu_begin_window(ctx, "Demo Window", mu_rect(40, 40, 300, 450))) {
+    mu_Container* win = mu_get_current_container(ctx);
+    win->rect.w = mu_max(win->rect.w, 240);
+    win->rect.h = mu_max(win->rect.h, 300);
+
+    /* window info */
+    if (mu_header(ctx, "Window Info")) {
+      mu_Container* win = mu_get_current_container(ctx);
+      char buf[64];
+      const int widths[] = { 54, -1 };
+      mu_layout_row(ctx, 2, widths, 0);
+      mu_label(ctx, "Position:");
+      snprintf(buf, sizeof(buf), "%d, %d", win->rect.x, win->rect.y); mu_label(ctx, buf);
+      mu_label(ctx, "Size:");
+      snprintf(buf, sizeof(buf), "%d, %d", win->rect.w, win->rect.h); mu_label(ctx, buf);
+    }
+
+    /* labels + buttons */
+    if (mu_header_ex(ctx, "Test Buttons", MU_OPT_EXPANDED)) {
+      const int widths[] = { 86, -110, -1 };
+      mu_layout_row(ctx, 3, widths, 0);
+      mu_label(ctx, "Test buttons 1:");
+      if (mu_button(ctx, "Button 1")) { write_log(d, "Pressed button 1"); }
+      if (mu_button(ctx, "Button 2")) { write_log(d, "Pressed button 2"); }
+      mu_label(ctx, "Test buttons 2:");
+      if (mu_button(ctx, "Button 3")) { write_log(d, "Pressed button 3"); }
+      if (mu_button(ctx, "Popup")) { mu_open_popup(ctx, "Test Popup"); }
+      if (mu_begin_popup(ctx, "Test Popup")) {
+        mu_button(ctx, "Hello");
+        mu_button(ctx, "World");
+        mu_end_popup(ctx);
+      }
+    }
+
+    /* tree */
+    if (mu_header_ex(ctx, "Tree and Text", MU_OPT_EXPANDED)) {
+      const int widths0[] = { 140, -1 };
+      mu_layout_row(ctx, 2, widths0, 0);
+      mu_layout_begin_column(ctx);
+      if (mu_begin_treenode(ctx, "Test 1")) {
+        if (mu_begin_treenode(ctx, "Test 1a")) {
+          mu_label(ctx, "Hello");
+          mu_label(ctx, "world");
+          mu_end_treenode(ctx);
+        }
+        if (mu_begin_treenode(ctx, "Test 1b")) {
+          if (mu_button(ctx, "Button 1")) { write_log(d, "Pressed button 1"); }
+          if (mu_button(ctx, "Button 2")) { write_log(d, "Pressed button 2"); }
+          mu_end_treenode(ctx);
+        }
+        mu_end_treenode(ctx);
+      }
+      if (mu_begin_treenode(ctx, "Test 2")) {
+        const int widths1[] = { 54, 54 };
+        mu_layout_row(ctx, 2, widths1, 0);
+        if (mu_button(ctx, "Button 3")) { write_log(d, "Pressed button 3"); }
+        if (mu_button(ctx, "Button 4")) { write_log(d, "Pressed button 4"); }
+        if (mu_button(ctx, "Button 5")) { write_log(d, "Pressed button 5"); }
+        if (mu_button(ctx, "Button 6")) { write_log(d, "Pressed button 6"); }
+        mu_end_treenode(ctx);
+      }
+      if (mu_begin_treenode(ctx, "Test 3")) {
+        mu_checkbox(ctx, "Checkbox 1", &d->checks[0]);
+        mu_checkbox(ctx, "Checkbox 2", &d->checks[1]);
+        mu_checkbox(ctx, "Checkbox 3", &d->checks[2]);
+        mu_end_treenode(ctx);
+      }
+      mu_layout_end_column(ctx);
+
+      mu_layout_begin_column(ctx);
+      const int widths2[] = { -1 };
+      mu_layout_row(ctx, 1, widths2, 0);
+      mu_text(ctx, "Lorem ipsum dolor sit amet, consectetur adipiscing "
+        "elit. Maecenas lacinia, sem eu lacinia molestie, mi risus faucibus "
+        "ipsum, eu varius magna felis a nulla.");
+      mu_layout_end_column(ctx);
+    }
+
+    /* background color sliders */
+    if (mu_header_ex(ctx, "Background Color", MU_OPT_EXPANDED)) {
+      const int widths0[] = { -78, -1 };
+      mu_layout_row(ctx, 2, widths0, 74);
+      /* sliders */
+      mu_layout_begin_column(ctx);
+      const int widths1[] = { 46, -1 };
+      mu_layout_row(ctx, 2, widths1, 0);
+      mu_label(ctx, "Red:");   mu_slider(ctx, &d->bg[0], 0, 255);
+      mu_label(ctx, "Green:"); mu_slider(ctx, &d->bg[1], 0, 255);
+      mu_label(ctx, "Blue:");  mu_slider(ctx, &d->bg[2], 0, 255);
+      mu_layout_end_column(ctx);
+      /* color preview */
+      mu_Rect r = mu_layout_next(ctx);
+      mu_draw_rect(ctx, r, demo_state_background(d));
+      char buf[32];
+      snprintf(buf, sizeof(buf), "#%02X%02X%02X", (int)d->bg[0], (int)d->bg[1], (int)d->bg[2]);
+      mu_draw_control_text(ctx, buf, r, MU_COLOR_TEXT, MU_OPT_ALIGNCENTER);
+    }
+
+    mu_end_window(ctx);
+  }
+}
+
+static void log_window(mu_Context* ctx, DemoState* d) {
+  /* replayed while the log is unchanged and the window isn't in use */
+  if (mu_begin_window_memo(ctx, "Log Window", mu_rect(350, 40, 300, 200), 0, d->log_version)) {
+    /* output text panel */
+    const int widths0[] = { -1 };
+    mu_layout_row(ctx, 1, widths0, -25);
+    mu_begin_panel(ctx, "Log Output");
+    mu_Container* panel = mu_get_current_container(ctx);
+    const int widths1[] = { -1 };
+    mu_layout_row(ctx, 1, widths1, -1);
+    mu_text(ctx, d->logbuf);
+    mu_end_panel(ctx);
+    if (d->logbuf_updated) {
+      panel->scroll.y = panel->content_size.y;
+      d->logbuf_updated = 0;
+      /* the scroll changes after the panel was built: build it once more */
+      d->log_version++;
+    }
+
+    /* input textbox + submit button */
+    char* buf = d->input;
+    int submitted = 0;
+    const int widths2[] = { -70, -1 };
+    mu_layout_row(ctx, 2, widths2, 0);
+    if (mu_textbox(ctx, buf, sizeof(d->input)) & MU_RES_SUBMIT) {
+      mu_set_focus(ctx, ctx->last_id);
+      submitted = 1;
+    }
+    if (mu_button(ctx, "Submit")) { submitted = 1; }
+    if (submitted) {
+      write_log(d, buf);
+      buf[0] = '\0';
+    }
+
+    mu_end_window(ctx);
+  }
+}
+
+static int uint8_slider(mu_Context* ctx, DemoState* d, unsigned char* value, int low, int high) {
+  float& tmp = d->slider_tmp;
+  mu_push_id(ctx, &value, sizeof(value));
+  tmp = *value;
+  int res = mu_slider_ex(ctx, &tmp, static_cast<mu_Real>(low), static_cast<mu_Real>(high), 0, "%.0f", MU_OPT_ALIGNCENTER);
+  *value = static_cast<uint8_t>(tmp);
+  mu_pop_id(ctx);
+  return res;
+}
+
+static void style_window(mu_Context* ctx, DemoState* d) {
+  static const struct { const char* label; int idx; } colors[] = {
+    { "text:",         MU_COLOR_TEXT        },
+    { "border:",       MU_COLOR_BORDER      },
+    { "windowbg:",     MU_COLOR_WINDOWBG    },
+    { "titlebg:",      MU_COLOR_TITLEBG     },
+    { "titletext:",    MU_COLOR_TITLETEXT   },
+    { "panelbg:",      MU_COLOR_PANELBG     },
+    { "button:",       MU_COLOR_BUTTON      },
+    { "buttonhover:",  MU_COLOR_BUTTONHOVER },
+    { "buttonfocus:",  MU_COLOR_BUTTONFOCUS },
+    { "base:",         MU_COLOR_BASE        },
+    { "basehover:",    MU_COLOR_BASEHOVER   },
+    { "basefocus:",    MU_COLOR_BASEFOCUS   },
+    { "scrollbase:",   MU_COLOR_SCROLLBASE  },
+    { "scrollthumb:",  MU_COLOR_SCROLLTHUMB },
+    { NULL }
+  };
+
+  if (mu_begin_window(ctx, "Style Editor", mu_rect(350, 250, 300, 240))) {
+    int sw = static_cast<int>(mu_get_current_container(ctx)->body.w * 0.14);
+    //mu_layout_row(ctx, 6, (int[]) { 80, sw, sw, sw, sw, -1 }, 0);
+    const int widths[] = { 80, sw, sw, sw, sw, -1 };
+    mu_layout_row(ctx, 6, widths, 0);
+    for (int i = 0; colors[i].label; i++) {
+      mu_label(ctx, colors[i].label);
+      uint8_slider(ctx, d, &ctx->style->colors[i].r, 0, 255);
+      uint8_slider(ctx, d, &ctx->style->colors[i].g, 0, 255);
+      uint8_slider(ctx, d, &ctx->style->colors[i].b, 0, 255);
+      uint8_slider(ctx, d, &ctx->style->colors[i].a, 0, 255);
+      mu_draw_rect(ctx, mu_layout_next(ctx), ctx->style->colors[i]);
+    }
+    mu_end_window(ctx);
+  }
+}
+
+void demo_frame(mu_Context* ctx, DemoState* d) {
+  mu_begin(ctx);
+  style_window(ctx, d);
+  log_window(ctx, d);
+  test_window(ctx, d);
+  ps_window(ctx);
+  mu_end(ctx);
+}
+
+mu_Color demo_state_background(const DemoState* d) {
+  return mu_color(static_cast<int>(d->bg[0]), static_cast<int>(d->bg[1]), static_cast<int>(d->bg[2]), 255);
+}
+
+void process_frame(mu_Context* ctx) {
+  demo_frame(ctx, &default_state);
+}
+
+mu_Color demo_background() {
+  return demo_state_background(&default_state);
+}
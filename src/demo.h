@@ -0,0 +1,31 @@
+#ifndef DEMO_H
+#define DEMO_H
+extern "C" {
+#include "microui.h"
+}
+
+/* everything the sample UI keeps between frames. give each mu_Context its
+** own, and separate contexts can be built on different threads at once */
+struct DemoState {
+  char logbuf[64000];
+  int logbuf_updated;
+  /* bumped whenever the log window's contents change; it is memoized */
+  unsigned log_version;
+  float bg[3];
+  int checks[3];
+  char input[128];
+  /* uint8_slider()'s float copy; its address is part of the slider ids */
+  float slider_tmp;
+};
+
+void demo_init(DemoState* d);
+/* the sample UI: demo, log and style editor windows */
+void demo_frame(mu_Context* ctx, DemoState* d);
+/* background color picked in the demo window */
+mu_Color demo_state_background(const DemoState* d);
+
+/* the same on one process-wide state, for the single-window paths */
+void process_frame(mu_Context* ctx);
+mu_Color demo_background();
+
+#endif
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <stdio.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "frame_pacer.h"
+
+#define HISTORY_SIZE    16
+/* safety margin on top of the slowest recent frame */
+#define LATCH_MARGIN    0.001
+/* sleeps shorter than this are spun out with yields */
+#define SPIN_THRESHOLD  0.002
+#define REPORT_INTERVAL 2.0
+
+static double period = 1.0 / 60.0;
+static double last_present = -1.0;
+static double predicted = -1.0;
+static double build_history[HISTORY_SIZE];
+static double render_history[HISTORY_SIZE];
+static int history_idx;
+
+static double error_last, error_total, error_max;
+static double report_start = -1.0;
+static int error_frames;
+
+
+static double slowest(const double* history) {
+  double res = 0.0;
+  for (int i = 0; i < HISTORY_SIZE; i++) {
+    if (history[i] > res) { res = history[i]; }
+  }
+  return res;
+}
+
+
+void fp_init(double refresh_rate) {
+  if (refresh_rate > 0.0) { period = 1.0 / refresh_rate; }
+}
+
+
+void fp_wait(void) {
+  double now = glfwGetTime();
+  if (last_present < 0.0) { return; }
+
+  /* swap returns at (about) a vblank, so vblanks fall on last_present + k * period;
+  ** pick the first one the frame can still make */
+  double work = slowest(build_history) + slowest(render_history) + LATCH_MARGIN;
+  double k = std::ceil((now + work - last_present) / period);
+  if (k < 1.0) { k = 1.0; }
+  predicted = last_present + k * period;
+
+  double latch = predicted - work;
+  double remaining = latch - now;
+  if (remaining > SPIN_THRESHOLD) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_THRESHOLD));
+  }
+  while (glfwGetTime() < latch) { std::this_thread::yield(); }
+}
+
+
+void fp_frame(double latch_time, double build_time, double render_time, double present_time) {
+  build_history[history_idx] = build_time - latch_time;
+  render_history[history_idx] = render_time - build_time;
+  history_idx = (history_idx + 1) % HISTORY_SIZE;
+  last_present = present_time;
+
+  if (predicted < 0.0) { return; }
+  error_last = present_time - predicted;
+  error_total += std::fabs(error_last);
+  if (std::fabs(error_last) > error_max) { error_max = std::fabs(error_last); }
+  error_frames++;
+
+  if (report_start < 0.0) { report_start = present_time; }
+  if (present_time - report_start >= REPORT_INTERVAL) {
+    printf("pacing: present vs predicted vblank avg %.2f ms, max %.2f ms, latch lead %.2f ms (%d frames)\n",
+      error_total * 1000.0 / error_frames, error_max * 1000.0,
+      (slowest(build_history) + slowest(render_history) + LATCH_MARGIN) * 1000.0, error_frames);
+    report_start = present_time;
+    error_total = error_max = 0.0;
+    error_frames = 0;
+  }
+}
+
+
+double fp_prediction_error(void) {
+  return error_last;
+}
@@ -0,0 +1,17 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+/* late-latch frame pacing: instead of polling right after the previous
+** present, sleep until just before the predicted vblank minus the recent
+** build and render cost, then poll input and build. all times are
+** glfwGetTime() seconds */
+void fp_init(double refresh_rate);
+/* sleeps until the latch point for the next vblank */
+void fp_wait(void);
+/* reports one frame: when input was latched, when the UI was built, when
+** rendering was submitted and when glfwSwapBuffers() returned */
+void fp_frame(double latch_time, double build_time, double render_time, double present_time);
+/* last present time minus the vblank it was predicted for */
+double fp_prediction_error(void);
+
+#endif
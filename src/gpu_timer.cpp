@@ -0,0 +1,100 @@
+#include <glad/glad.h>
+#include "gpu_timer.h"
+#include "perf_stats.h"
+
+/* frames in flight before a slot is reused, and timed segments per frame */
+#define GT_FRAMES  4
+#define GT_QUERIES 64
+
+struct GtFrame {
+  GLuint queries[GT_QUERIES];
+  int count;
+  bool pending;
+};
+
+static GtFrame frames[GT_FRAMES];
+static int current;
+static bool available;
+static bool in_frame, in_query;
+
+
+void gt_init(void) {
+  available = GLAD_GL_VERSION_3_3 && glad_glGenQueries && glad_glGetQueryiv && glad_glGetQueryObjectui64v;
+  if (available) {
+    GLint bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    available = bits > 0;
+  }
+  /* don't leave an error behind for the asserts in r_create() */
+  while (glGetError() != GL_NO_ERROR) {}
+  if (!available) { return; }
+  for (GtFrame& f : frames) {
+    glGenQueries(GT_QUERIES, f.queries);
+    f.count = 0;
+    f.pending = false;
+  }
+}
+
+
+int gt_available(void) {
+  return available;
+}
+
+
+/* reads a finished frame's results if the GPU has them; never waits */
+static bool collect(GtFrame& f) {
+  GLint ready = 0;
+  glGetQueryObjectiv(f.queries[f.count - 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+  if (!ready) { return false; }
+  GLuint64 total = 0, longest = 0;
+  for (int i = 0; i < f.count; i++) {
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(f.queries[i], GL_QUERY_RESULT, &ns);
+    total += ns;
+    if (ns > longest) { longest = ns; }
+  }
+  ps_set_gpu_time(total / 1e6, longest / 1e6, f.count);
+  f.pending = false;
+  return true;
+}
+
+
+void gt_frame_begin(void) {
+  if (!available) { return; }
+  GtFrame& f = frames[current];
+  /* a slot still pending means the GPU is GT_FRAMES behind: drop its
+  ** results rather than stall */
+  f.pending = false;
+  f.count = 0;
+  in_frame = true;
+}
+
+
+void gt_frame_end(void) {
+  if (!available || !in_frame) { return; }
+  in_frame = false;
+  frames[current].pending = frames[current].count > 0;
+  current = (current + 1) % GT_FRAMES;
+  /* oldest first, so results are published in frame order */
+  for (int i = 0; i < GT_FRAMES; i++) {
+    GtFrame& f = frames[(current + i) % GT_FRAMES];
+    if (f.pending && !collect(f)) { break; }
+  }
+}
+
+
+void gt_begin(void) {
+  if (!available || !in_frame || in_query) { return; }
+  GtFrame& f = frames[current];
+  if (f.count == GT_QUERIES) { return; }
+  glBeginQuery(GL_TIME_ELAPSED, f.queries[f.count]);
+  in_query = true;
+}
+
+
+void gt_end(void) {
+  if (!in_query) { return; }
+  glEndQuery(GL_TIME_ELAPSED);
+  frames[current].count++;
+  in_query = false;
+}
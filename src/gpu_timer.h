@@ -0,0 +1,18 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+/* GPU timing with GL_TIME_ELAPSED queries. each frame gets its own set of
+** query objects from a small ring, and results are only read once the GPU
+** reports them available, so nothing ever stalls; they arrive a few frames
+** late and are handed to ps_set_gpu_time(). without timer query support
+** (no GL 3.3, or zero counter bits as on some software rasterizers) every
+** call is a no-op */
+void gt_init(void);
+ int gt_available(void);
+void gt_frame_begin(void);
+void gt_frame_end(void);
+/* brackets one timed segment, e.g. a draw call; segments can't nest */
+void gt_begin(void);
+void gt_end(void);
+
+#endif
@@ -0,0 +1,106 @@
+#include <cstring>
+#include <vector>
+#include "input_queue.h"
+#include "input_record.h"
+
+struct iq_Queue {
+  std::vector<iq_Event> events;
+  double probe_time = -1.0;
+};
+
+
+iq_Queue* iq_create(void) {
+  return new iq_Queue();
+}
+
+
+void iq_destroy(iq_Queue* q) {
+  delete q;
+}
+
+
+void iq_push(iq_Queue* q, const iq_Event* ev) {
+  q->events.push_back(*ev);
+}
+
+
+void iq_push_codepoint(iq_Queue* q, unsigned int codepoint, double time) {
+  iq_Event ev = {};
+  ev.type = IQ_TEXT;
+  ev.time = time;
+  char* t = ev.text;
+  if (codepoint < 0x80) {
+    t[0] = static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    t[0] = static_cast<char>(0xc0 | (codepoint >> 6));
+    t[1] = static_cast<char>(0x80 | (codepoint & 0x3f));
+  } else if (codepoint < 0x10000) {
+    t[0] = static_cast<char>(0xe0 | (codepoint >> 12));
+    t[1] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+    t[2] = static_cast<char>(0x80 | (codepoint & 0x3f));
+  } else {
+    t[0] = static_cast<char>(0xf0 | (codepoint >> 18));
+    t[1] = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f));
+    t[2] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+    t[3] = static_cast<char>(0x80 | (codepoint & 0x3f));
+  }
+  iq_push(q, &ev);
+}
+
+
+int iq_pending(const iq_Queue* q) {
+  return static_cast<int>(q->events.size());
+}
+
+
+static bool apply(mu_Context* ctx, const iq_Event& ev) {
+  switch (ev.type) {
+  case IQ_MOUSEMOVE:
+    ir_input_mousemove(ctx, ev.x, ev.y);
+    break;
+  case IQ_MOUSEDOWN:
+    /* a second press of the same button would collapse into one click */
+    if (ctx->mouse_pressed & ev.value) { return false; }
+    ir_input_mousedown(ctx, ev.x, ev.y, ev.value);
+    break;
+  case IQ_MOUSEUP:
+    ir_input_mouseup(ctx, ev.x, ev.y, ev.value);
+    break;
+  case IQ_SCROLL:
+    ir_input_scroll(ctx, ev.x, ev.y);
+    break;
+  case IQ_KEYDOWN:
+    if (ctx->key_pressed & ev.value) { return false; }
+    ir_input_keydown(ctx, ev.value);
+    break;
+  case IQ_KEYUP:
+    ir_input_keyup(ctx, ev.value);
+    break;
+  case IQ_TEXT: {
+    size_t len = strlen(ctx->input_text);
+    if (len + strlen(ev.text) + 1 > sizeof(ctx->input_text)) { return false; }
+    ir_input_text(ctx, ev.text);
+    break;
+  }
+  }
+  return true;
+}
+
+
+int iq_drain(iq_Queue* q, mu_Context* ctx) {
+  std::vector<iq_Event>& events = q->events;
+  size_t n = 0;
+  while (n < events.size() && apply(ctx, events[n])) {
+    if (events[n].probe && q->probe_time < 0.0) { q->probe_time = events[n].time; }
+    n++;
+  }
+  events.erase(events.begin(), events.begin() + n);
+  return static_cast<int>(n);
+}
+
+
+double iq_take_probe_time(iq_Queue* q) {
+  double t = q->probe_time;
+  q->probe_time = -1.0;
+  return t;
+}
@@ -0,0 +1,47 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+extern "C" {
+#include "microui.h"
+}
+
+enum {
+  IQ_MOUSEMOVE,
+  IQ_MOUSEDOWN,
+  IQ_MOUSEUP,
+  IQ_SCROLL,
+  IQ_KEYDOWN,
+  IQ_KEYUP,
+  IQ_TEXT
+};
+
+/* one input event as reported by a GLFW callback. `time` is glfwGetTime()
+** when the callback ran; `value` is the mouse button or key bit. `probe`
+** marks synthetic events injected by the latency probe */
+typedef struct {
+  int type;
+  double time;
+  int x, y;
+  int value;
+  int probe;
+  char text[8];
+} iq_Event;
+
+/* events bound for one mu_Context, e.g. one per window */
+typedef struct iq_Queue iq_Queue;
+
+iq_Queue* iq_create(void);
+void iq_destroy(iq_Queue* q);
+void iq_push(iq_Queue* q, const iq_Event* ev);
+/* queues a text event holding `codepoint` encoded as UTF-8 */
+void iq_push_codepoint(iq_Queue* q, unsigned int codepoint, double time);
+/* feeds queued events to the mu_input_* functions in arrival order. stops
+** early when an event would merge with one already applied this frame (a
+** second click, a repeated key, text that does not fit `input_text`); the
+** rest stays queued for the next frame. returns the number applied */
+ int iq_drain(iq_Queue* q, mu_Context* ctx);
+ int iq_pending(const iq_Queue* q);
+/* timestamp of the earliest probe event applied since the last call, or a
+** negative value if there was none; tags the frame that consumed it */
+double iq_take_probe_time(iq_Queue* q);
+
+#endif
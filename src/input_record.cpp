@@ -0,0 +1,246 @@
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+#include "input_record.h"
+
+/* file layout: the magic, then one record per mu_input_* call. a record is a
+** tag byte followed by its arguments as zigzag LEB128 varints; text is a
+** length byte and the bytes. mouse positions are deltas from the previous
+** one, so a typical move takes 3 bytes */
+static const char magic[8] = { 'M', 'U', 'I', 'R', 'E', 'C', '0', '1' };
+
+enum {
+  IR_FRAME,
+  IR_MOUSEMOVE,
+  IR_MOUSEDOWN,
+  IR_MOUSEUP,
+  IR_SCROLL,
+  IR_KEYDOWN,
+  IR_KEYUP,
+  IR_TEXT
+};
+
+static FILE* record_fp;
+static mu_Vec2 record_pos;
+
+
+static void put_varint(int value) {
+  unsigned v = (static_cast<unsigned>(value) << 1) ^ static_cast<unsigned>(value >> 31);
+  do {
+    unsigned char byte = v & 0x7f;
+    v >>= 7;
+    if (v) { byte |= 0x80; }
+    fputc(byte, record_fp);
+  } while (v);
+}
+
+
+static void put_pos(int x, int y) {
+  put_varint(x - record_pos.x);
+  put_varint(y - record_pos.y);
+  record_pos = mu_vec2(x, y);
+}
+
+
+int ir_record_open(const char* path) {
+  ir_record_close();
+  record_fp = fopen(path, "wb");
+  if (!record_fp) {
+    fprintf(stderr, "can't open '%s' for recording\n", path);
+    return 0;
+  }
+  fwrite(magic, 1, sizeof(magic), record_fp);
+  record_pos = mu_vec2(0, 0);
+  return 1;
+}
+
+
+void ir_record_close(void) {
+  if (!record_fp) { return; }
+  fclose(record_fp);
+  record_fp = NULL;
+}
+
+
+void ir_record_frame(void) {
+  if (record_fp) { fputc(IR_FRAME, record_fp); }
+}
+
+
+void ir_input_mousemove(mu_Context* ctx, int x, int y) {
+  if (record_fp) { fputc(IR_MOUSEMOVE, record_fp); put_pos(x, y); }
+  mu_input_mousemove(ctx, x, y);
+}
+
+
+void ir_input_mousedown(mu_Context* ctx, int x, int y, int btn) {
+  if (record_fp) { fputc(IR_MOUSEDOWN, record_fp); put_pos(x, y); put_varint(btn); }
+  mu_input_mousedown(ctx, x, y, btn);
+}
+
+
+void ir_input_mouseup(mu_Context* ctx, int x, int y, int btn) {
+  if (record_fp) { fputc(IR_MOUSEUP, record_fp); put_pos(x, y); put_varint(btn); }
+  mu_input_mouseup(ctx, x, y, btn);
+}
+
+
+void ir_input_scroll(mu_Context* ctx, int x, int y) {
+  if (record_fp) { fputc(IR_SCROLL, record_fp); put_varint(x); put_varint(y); }
+  mu_input_scroll(ctx, x, y);
+}
+
+
+void ir_input_keydown(mu_Context* ctx, int key) {
+  if (record_fp) { fputc(IR_KEYDOWN, record_fp); put_varint(key); }
+  mu_input_keydown(ctx, key);
+}
+
+
+void ir_input_keyup(mu_Context* ctx, int key) {
+  if (record_fp) { fputc(IR_KEYUP, record_fp); put_varint(key); }
+  mu_input_keyup(ctx, key);
+}
+
+
+void ir_input_text(mu_Context* ctx, const char* text) {
+  if (record_fp) {
+    size_t len = mu_min(strlen(text), static_cast<size_t>(255));
+    fputc(IR_TEXT, record_fp);
+    fputc(static_cast<int>(len), record_fp);
+    fwrite(text, 1, len, record_fp);
+  }
+  mu_input_text(ctx, text);
+}
+
+
+struct ir_Player {
+  std::vector<unsigned char> data;
+  size_t pos;
+  mu_Vec2 mouse;
+  int frames;
+};
+
+
+static bool get_varint(ir_Player* p, int* value) {
+  unsigned v = 0;
+  for (int shift = 0; p->pos < p->data.size() && shift < 35; shift += 7) {
+    unsigned char byte = p->data[p->pos++];
+    v |= static_cast<unsigned>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = static_cast<int>(v >> 1) ^ -static_cast<int>(v & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static bool get_pos(ir_Player* p) {
+  int dx, dy;
+  if (!get_varint(p, &dx) || !get_varint(p, &dy)) { return false; }
+  p->mouse.x += dx;
+  p->mouse.y += dy;
+  return true;
+}
+
+
+/* decodes one record and, when `ctx` is given, applies it. returns the tag,
+** -1 at the end of the data or -2 on a malformed record */
+static int step(ir_Player* p, mu_Context* ctx) {
+  if (p->pos >= p->data.size()) { return -1; }
+  int tag = p->data[p->pos++];
+  int a, b;
+  switch (tag) {
+  case IR_FRAME:
+    break;
+  case IR_MOUSEMOVE:
+    if (!get_pos(p)) { return -2; }
+    if (ctx) { mu_input_mousemove(ctx, p->mouse.x, p->mouse.y); }
+    break;
+  case IR_MOUSEDOWN:
+  case IR_MOUSEUP:
+    if (!get_pos(p) || !get_varint(p, &a)) { return -2; }
+    if (ctx && tag == IR_MOUSEDOWN) { mu_input_mousedown(ctx, p->mouse.x, p->mouse.y, a); }
+    if (ctx && tag == IR_MOUSEUP) { mu_input_mouseup(ctx, p->mouse.x, p->mouse.y, a); }
+    break;
+  case IR_SCROLL:
+    if (!get_varint(p, &a) || !get_varint(p, &b)) { return -2; }
+    if (ctx) { mu_input_scroll(ctx, a, b); }
+    break;
+  case IR_KEYDOWN:
+  case IR_KEYUP:
+    if (!get_varint(p, &a)) { return -2; }
+    if (ctx && tag == IR_KEYDOWN) { mu_input_keydown(ctx, a); }
+    if (ctx && tag == IR_KEYUP) { mu_input_keyup(ctx, a); }
+    break;
+  case IR_TEXT: {
+    if (p->pos >= p->data.size()) { return -2; }
+    size_t len = p->data[p->pos++];
+    if (p->pos + len > p->data.size()) { return -2; }
+    char text[256];
+    memcpy(text, &p->data[p->pos], len);
+    text[len] = '\0';
+    p->pos += len;
+    if (ctx) { mu_input_text(ctx, text); }
+    break;
+  }
+  default:
+    return -2;
+  }
+  return tag;
+}
+
+
+ir_Player* ir_player_open(const char* path) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return NULL;
+  }
+  ir_Player* p = new ir_Player();
+  unsigned char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) { p->data.insert(p->data.end(), buf, buf + n); }
+  fclose(fp);
+
+  if (p->data.size() < sizeof(magic) || memcmp(p->data.data(), magic, sizeof(magic)) != 0) {
+    fprintf(stderr, "'%s' is not an input recording\n", path);
+    delete p;
+    return NULL;
+  }
+
+  /* validate and count frames up front so replay never stops half way */
+  p->pos = sizeof(magic);
+  int tag;
+  while ((tag = step(p, NULL)) >= 0) {
+    if (tag == IR_FRAME) { p->frames++; }
+  }
+  if (tag == -2) {
+    fprintf(stderr, "'%s' is corrupt at byte %zu\n", path, p->pos);
+    delete p;
+    return NULL;
+  }
+  p->pos = sizeof(magic);
+  p->mouse = mu_vec2(0, 0);
+  return p;
+}
+
+
+void ir_player_close(ir_Player* player) {
+  delete player;
+}
+
+
+int ir_player_next_frame(ir_Player* player, mu_Context* ctx) {
+  int tag;
+  while ((tag = step(player, ctx)) >= 0) {
+    if (tag == IR_FRAME) { return 1; }
+  }
+  return 0;
+}
+
+
+int ir_player_frame_count(const ir_Player* player) {
+  return player->frames;
+}
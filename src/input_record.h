@@ -0,0 +1,32 @@
+#ifndef INPUT_RECORD_H
+#define INPUT_RECORD_H
+extern "C" {
+#include "microui.h"
+}
+
+/* input recording: the ir_input_* functions forward to mu_input_* and, while
+** a recording is open, append the call to a compact binary file. call
+** ir_record_frame() once per frame after the input has been fed so the
+** player can split the stream into the same frames */
+ int ir_record_open(const char* path);
+void ir_record_close(void);
+void ir_record_frame(void);
+
+void ir_input_mousemove(mu_Context* ctx, int x, int y);
+void ir_input_mousedown(mu_Context* ctx, int x, int y, int btn);
+void ir_input_mouseup(mu_Context* ctx, int x, int y, int btn);
+void ir_input_scroll(mu_Context* ctx, int x, int y);
+void ir_input_keydown(mu_Context* ctx, int key);
+void ir_input_keyup(mu_Context* ctx, int key);
+void ir_input_text(mu_Context* ctx, const char* text);
+
+/* deterministic replay of a recording into any mu_Context, no window needed */
+typedef struct ir_Player ir_Player;
+
+ir_Player* ir_player_open(const char* path);
+void ir_player_close(ir_Player* player);
+/* applies the next frame's input; returns 0 once the recording is exhausted */
+ int ir_player_next_frame(ir_Player* player, mu_Context* ctx);
+ int ir_player_frame_count(const ir_Player* player);
+
+#endif
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <stdio.h>
+#include "latency.h"
+
+#define REPORT_INTERVAL 2.0
+
+static double first_time = -1.0;
+static double total_latency, max_latency, total_wait;
+static int frames;
+
+void lat_frame(double input_time, double render_time, double present_time) {
+  if (first_time < 0.0) { first_time = present_time; }
+  double latency = present_time - input_time;
+  total_latency += latency;
+  total_wait += render_time - input_time;
+  if (latency > max_latency) { max_latency = latency; }
+  frames++;
+
+  if (present_time - first_time >= REPORT_INTERVAL) {
+    printf("latency: input->present avg %.2f ms, max %.2f ms, input->render avg %.2f ms (%d frames)\n",
+      total_latency * 1000.0 / frames, max_latency * 1000.0,
+      total_wait * 1000.0 / frames, frames);
+    first_time = present_time;
+    total_latency = max_latency = total_wait = 0.0;
+    frames = 0;
+  }
+}
+
+
+/* samples are written by whichever thread presents; only the count is read
+** from the UI thread */
+static std::vector<double> probe_samples;
+static std::atomic<int> probe_count{ 0 };
+static int probe_warmup;
+
+void lat_probe_begin(int samples, int warmup) {
+  probe_samples.assign(samples, 0.0);
+  probe_count.store(0);
+  probe_warmup = warmup;
+}
+
+
+void lat_probe_sample(double inject_time, double present_time) {
+  if (probe_warmup > 0) { probe_warmup--; return; }
+  int n = probe_count.load(std::memory_order_relaxed);
+  if (n == static_cast<int>(probe_samples.size())) { return; }
+  probe_samples[n] = present_time - inject_time;
+  probe_count.store(n + 1, std::memory_order_release);
+}
+
+
+int lat_probe_done(void) {
+  return !probe_samples.empty() &&
+    probe_count.load(std::memory_order_acquire) == static_cast<int>(probe_samples.size());
+}
+
+
+static double percentile(const std::vector<double>& sorted, double p) {
+  /* nearest rank */
+  size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+  rank = std::clamp<size_t>(rank, 1, sorted.size());
+  return sorted[rank - 1];
+}
+
+
+void lat_probe_report(const char* config) {
+  std::vector<double> sorted(probe_samples.begin(), probe_samples.begin() + probe_count.load());
+  if (sorted.empty()) { return; }
+  std::sort(sorted.begin(), sorted.end());
+  printf("probe [%s] n=%d p50 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.2f ms\n",
+    config, static_cast<int>(sorted.size()),
+    percentile(sorted, 50.0) * 1000.0, percentile(sorted, 99.0) * 1000.0,
+    percentile(sorted, 99.9) * 1000.0, sorted.back() * 1000.0);
+}
@@ -0,0 +1,17 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/* rolling input-to-present latency, printed to stdout every couple of
+** seconds. times are glfwGetTime() seconds: when input was sampled, when the
+** renderer picked the frame up and when glfwSwapBuffers() returned */
+void lat_frame(double input_time, double render_time, double present_time);
+
+/* latency probe: collects input-to-present samples for frames tagged with a
+** synthetic input event and prints their percentiles. the first `warmup`
+** samples are discarded */
+void lat_probe_begin(int samples, int warmup);
+void lat_probe_sample(double inject_time, double present_time);
+ int lat_probe_done(void);
+void lat_probe_report(const char* config);
+
+#endif
@@ -2,6 +2,7 @@
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
+#include <cmath>
 #include <cstdlib>
 #include <stdlib.h>
 #include <stdio.h>
@@ -10,238 +11,135 @@ extern "C" {
 #include "microui.h"
 }
 #include "renderer.h"
+#include "pipeline.h"
+#include "latency.h"
+#include "input_queue.h"
+#include "input_record.h"
+#include "capture.h"
+#include "perf_stats.h"
+#include "alloc_track.h"
+#include "trace.h"
+#include "frame_pacer.h"
+#include "demo.h"
+#include "viewports.h"
+#include "occlusion.h"
 
 static void error_callback(int error, const char* description)
 {
   fprintf(stderr, "Error: %s\n", description);
 }
 
+static double cursor_x = 0.0, cursor_y = 0.0;
+static iq_Queue* input_queue;
+static bool trace_dump_requested = false;
+
+static void push_event(int type, int x, int y, int value)
+{
+  iq_Event ev = {};
+  ev.type = type;
+  ev.time = glfwGetTime();
+  ev.x = x;
+  ev.y = y;
+  ev.value = value;
+  iq_push(input_queue, &ev);
+}
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
   if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
     glfwSetWindowShouldClose(window, GLFW_TRUE);
   }
+  if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+    trace_dump_requested = true;
+  }
+  constexpr std::pair<int, int> keytbl[] = {
+    {GLFW_KEY_LEFT_SHIFT, MU_KEY_SHIFT},
+    {GLFW_KEY_RIGHT_SHIFT, MU_KEY_SHIFT},
+    {GLFW_KEY_LEFT_CONTROL, MU_KEY_CTRL},
+    {GLFW_KEY_RIGHT_CONTROL, MU_KEY_CTRL},
+    {GLFW_KEY_LEFT_ALT, MU_KEY_ALT},
+    {GLFW_KEY_RIGHT_ALT, MU_KEY_ALT},
+    {GLFW_KEY_ENTER, MU_KEY_RETURN},
+    {GLFW_KEY_BACKSPACE, MU_KEY_BACKSPACE},
+  };
+  for (const auto& p : keytbl) {
+    if (p.first != key) { continue; }
+    // repeats count as presses so held backspace keeps deleting
+    push_event(action == GLFW_RELEASE ? IQ_KEYUP : IQ_KEYDOWN, 0, 0, p.second);
+  }
 }
 
-static double mouse_wheel = 0.0;
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+static void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
 {
-  mouse_wheel = yoffset;
+  cursor_x = xpos;
+  cursor_y = ypos;
+  push_event(IQ_MOUSEMOVE, static_cast<int>(xpos), static_cast<int>(ypos), 0);
 }
 
-static uint32_t character_codepoint = 0;
-static void character_callback(GLFWwindow* window, unsigned int codepoint)
+static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
-  character_codepoint = codepoint;
-}
-
-static  char logbuf[64000];
-static   int logbuf_updated = 0;
-static float bg[3] = { 90, 95, 100 };
-
-static void write_log(const char* text) {
-  //FIXME:strcat_s  
-  if (logbuf[0]) { strcat_s(logbuf, "\n"); }
-  strcat_s(logbuf, text);
-  logbuf_updated = 1;
-}
-
-static void test_window(mu_Context* ctx) {
-  /* do window */
-  if (mu_begin_window(ctx, "Demo Window", mu_rect(40, 40, 300, 450))) {
-    mu_Container* win = mu_get_current_container(ctx);
-    win->rect.w = mu_max(win->rect.w, 240);
-    win->rect.h = mu_max(win->rect.h, 300);
-
-    /* window info */
-    if (mu_header(ctx, "Window Info")) {
-      mu_Container* win = mu_get_current_container(ctx);
-      char buf[64];
-      const int widths[] = { 54, -1 };
-      mu_layout_row(ctx, 2, widths, 0);
-      mu_label(ctx, "Position:");
-      snprintf(buf, sizeof(buf), "%d, %d", win->rect.x, win->rect.y); mu_label(ctx, buf);
-      mu_label(ctx, "Size:");
-      snprintf(buf, sizeof(buf), "%d, %d", win->rect.w, win->rect.h); mu_label(ctx, buf);
-    }
-
-    /* labels + buttons */
-    if (mu_header_ex(ctx, "Test Buttons", MU_OPT_EXPANDED)) {
-      const int widths[] = { 86, -110, -1 };
-      mu_layout_row(ctx, 3, widths, 0);
-      mu_label(ctx, "Test buttons 1:");
-      if (mu_button(ctx, "Button 1")) { write_log("Pressed button 1"); }
-      if (mu_button(ctx, "Button 2")) { write_log("Pressed button 2"); }
-      mu_label(ctx, "Test buttons 2:");
-      if (mu_button(ctx, "Button 3")) { write_log("Pressed button 3"); }
-      if (mu_button(ctx, "Popup")) { mu_open_popup(ctx, "Test Popup"); }
-      if (mu_begin_popup(ctx, "Test Popup")) {
-        mu_button(ctx, "Hello");
-        mu_button(ctx, "World");
-        mu_end_popup(ctx);
-      }
-    }
-
-    /* tree */
-    if (mu_header_ex(ctx, "Tree and Text", MU_OPT_EXPANDED)) {
-      const int widths0[] = { 140, -1 };
-      mu_layout_row(ctx, 2, widths0, 0);
-      mu_layout_begin_column(ctx);
-      if (mu_begin_treenode(ctx, "Test 1")) {
-        if (mu_begin_treenode(ctx, "Test 1a")) {
-          mu_label(ctx, "Hello");
-          mu_label(ctx, "world");
-          mu_end_treenode(ctx);
-        }
-        if (mu_begin_treenode(ctx, "Test 1b")) {
-          if (mu_button(ctx, "Button 1")) { write_log("Pressed button 1"); }
-          if (mu_button(ctx, "Button 2")) { write_log("Pressed button 2"); }
-          mu_end_treenode(ctx);
-        }
-        mu_end_treenode(ctx);
-      }
-      if (mu_begin_treenode(ctx, "Test 2")) {
-        const int widths1[] = { 54, 54 };
-        mu_layout_row(ctx, 2, widths1, 0);
-        if (mu_button(ctx, "Button 3")) { write_log("Pressed button 3"); }
-        if (mu_button(ctx, "Button 4")) { write_log("Pressed button 4"); }
-        if (mu_button(ctx, "Button 5")) { write_log("Pressed button 5"); }
-        if (mu_button(ctx, "Button 6")) { write_log("Pressed button 6"); }
-        mu_end_treenode(ctx);
-      }
-      if (mu_begin_treenode(ctx, "Test 3")) {
-        static int checks[3] = { 1, 0, 1 };
-        mu_checkbox(ctx, "Checkbox 1", &checks[0]);
-        mu_checkbox(ctx, "Checkbox 2", &checks[1]);
-        mu_checkbox(ctx, "Checkbox 3", &checks[2]);
-        mu_end_treenode(ctx);
-      }
-      mu_layout_end_column(ctx);
-
-      mu_layout_begin_column(ctx);
-      const int widths2[] = { -1 };
-      mu_layout_row(ctx, 1, widths2, 0);
-      mu_text(ctx, "Lorem ipsum dolor sit amet, consectetur adipiscing "
-        "elit. Maecenas lacinia, sem eu lacinia molestie, mi risus faucibus "
-        "ipsum, eu varius magna felis a nulla.");
-      mu_layout_end_column(ctx);
-    }
-
-    /* background color sliders */
-    if (mu_header_ex(ctx, "Background Color", MU_OPT_EXPANDED)) {
-      const int widths0[] = { -78, -1 };
-      mu_layout_row(ctx, 2, widths0, 74);
-      /* sliders */
-      mu_layout_begin_column(ctx);
-      const int widths1[] = { 46, -1 };
-      mu_layout_row(ctx, 2, widths1, 0);
-      mu_label(ctx, "Red:");   mu_slider(ctx, &bg[0], 0, 255);
-      mu_label(ctx, "Green:"); mu_slider(ctx, &bg[1], 0, 255);
-      mu_label(ctx, "Blue:");  mu_slider(ctx, &bg[2], 0, 255);
-      mu_layout_end_column(ctx);
-      /* color preview */
-      mu_Rect r = mu_layout_next(ctx);
-      mu_draw_rect(ctx, r, mu_color(static_cast<int>(bg[0]), static_cast<int>(bg[1]), static_cast<int>(bg[2]), 255));
-      char buf[32];
-      snprintf(buf, sizeof(buf), "#%02X%02X%02X", (int)bg[0], (int)bg[1], (int)bg[2]);
-      mu_draw_control_text(ctx, buf, r, MU_COLOR_TEXT, MU_OPT_ALIGNCENTER);
-    }
-
-    mu_end_window(ctx);
+  constexpr std::pair<int, int> tbl[] = {
+    {GLFW_MOUSE_BUTTON_LEFT, MU_MOUSE_LEFT},
+    {GLFW_MOUSE_BUTTON_MIDDLE, MU_MOUSE_MIDDLE},
+    {GLFW_MOUSE_BUTTON_RIGHT, MU_MOUSE_RIGHT},
+  };
+  for (const auto& p : tbl) {
+    if (p.first != button) { continue; }
+    push_event(action == GLFW_PRESS ? IQ_MOUSEDOWN : IQ_MOUSEUP,
+      static_cast<int>(cursor_x), static_cast<int>(cursor_y), p.second);
   }
 }
 
-static void log_window(mu_Context* ctx) {
-  if (mu_begin_window(ctx, "Log Window", mu_rect(350, 40, 300, 200))) {
-    /* output text panel */
-    const int widths0[] = { -1 };
-    mu_layout_row(ctx, 1, widths0, -25);
-    mu_begin_panel(ctx, "Log Output");
-    mu_Container* panel = mu_get_current_container(ctx);
-    const int widths1[] = { -1 };
-    mu_layout_row(ctx, 1, widths1, -1);
-    mu_text(ctx, logbuf);
-    mu_end_panel(ctx);
-    if (logbuf_updated) {
-      panel->scroll.y = panel->content_size.y;
-      logbuf_updated = 0;
-    }
-
-    /* input textbox + submit button */
-    static char buf[128];
-    int submitted = 0;
-    const int widths2[] = { -70, -1 };
-    mu_layout_row(ctx, 2, widths2, 0);
-    if (mu_textbox(ctx, buf, sizeof(buf)) & MU_RES_SUBMIT) {
-      mu_set_focus(ctx, ctx->last_id);
-      submitted = 1;
-    }
-    if (mu_button(ctx, "Submit")) { submitted = 1; }
-    if (submitted) {
-      write_log(buf);
-      buf[0] = '\0';
-    }
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+  push_event(IQ_SCROLL, 0, static_cast<int>(yoffset * -30), 0);
+}
 
-    mu_end_window(ctx);
-  }
+static void character_callback(GLFWwindow* window, unsigned int codepoint)
+{
+  iq_push_codepoint(input_queue, codepoint, glfwGetTime());
 }
 
-static int uint8_slider(mu_Context* ctx, unsigned char* value, int low, int high) {
-  static float tmp;
-  mu_push_id(ctx, &value, sizeof(value));
-  tmp = *value;
-  int res = mu_slider_ex(ctx, &tmp, static_cast<mu_Real>(low), static_cast<mu_Real>(high), 0, "%.0f", MU_OPT_ALIGNCENTER);
-  *value = static_cast<uint8_t>(tmp);
-  mu_pop_id(ctx);
-  return res;
+/* latency probe: a synthetic cursor wiggle timestamped just before polling */
+static void inject_probe_event()
+{
+  static int flip = 0;
+  flip ^= 1;
+  iq_Event ev = {};
+  ev.type = IQ_MOUSEMOVE;
+  ev.time = glfwGetTime();
+  ev.x = static_cast<int>(cursor_x) + flip;
+  ev.y = static_cast<int>(cursor_y);
+  ev.probe = 1;
+  iq_push(input_queue, &ev);
 }
 
-static void style_window(mu_Context* ctx) {
-  static struct { const char* label; int idx; } colors[] = {
-    { "text:",         MU_COLOR_TEXT        },
-    { "border:",       MU_COLOR_BORDER      },
-    { "windowbg:",     MU_COLOR_WINDOWBG    },
-    { "titlebg:",      MU_COLOR_TITLEBG     },
-    { "titletext:",    MU_COLOR_TITLETEXT   },
-    { "panelbg:",      MU_COLOR_PANELBG     },
-    { "button:",       MU_COLOR_BUTTON      },
-    { "buttonhover:",  MU_COLOR_BUTTONHOVER },
-    { "buttonfocus:",  MU_COLOR_BUTTONFOCUS },
-    { "base:",         MU_COLOR_BASE        },
-    { "basehover:",    MU_COLOR_BASEHOVER   },
-    { "basefocus:",    MU_COLOR_BASEFOCUS   },
-    { "scrollbase:",   MU_COLOR_SCROLLBASE  },
-    { "scrollthumb:",  MU_COLOR_SCROLLTHUMB },
-    { NULL }
-  };
+/* allocation check: a scripted mouse sweep with periodic scrolling, then
+** any allocation in the UI, render or GL scopes fails the run */
+#define ALLOC_CHECK_WARMUP 120
 
-  if (mu_begin_window(ctx, "Style Editor", mu_rect(350, 250, 300, 240))) {
-    int sw = static_cast<int>(mu_get_current_container(ctx)->body.w * 0.14);
-    //mu_layout_row(ctx, 6, (int[]) { 80, sw, sw, sw, sw, -1 }, 0);
-    const int widths[] = { 80, sw, sw, sw, sw, -1 };
-    mu_layout_row(ctx, 6, widths, 0);
-    for (int i = 0; colors[i].label; i++) {
-      mu_label(ctx, colors[i].label);
-      uint8_slider(ctx, &ctx->style->colors[i].r, 0, 255);
-      uint8_slider(ctx, &ctx->style->colors[i].g, 0, 255);
-      uint8_slider(ctx, &ctx->style->colors[i].b, 0, 255);
-      uint8_slider(ctx, &ctx->style->colors[i].a, 0, 255);
-      mu_draw_rect(ctx, mu_layout_next(ctx), ctx->style->colors[i]);
-    }
-    mu_end_window(ctx);
-  }
+static void inject_sweep_event(int frame)
+{
+  double t = frame * 0.05;
+  push_event(IQ_MOUSEMOVE, static_cast<int>(400 + 380 * std::sin(t * 1.3)), static_cast<int>(300 + 280 * std::sin(t * 0.7)), 0);
+  if (frame % 8 == 0) { push_event(IQ_SCROLL, 0, (frame / 8) % 2 ? -30 : 30, 0); }
 }
 
-void process_frame(mu_Context* ctx) {
-  mu_begin(ctx);
-  style_window(ctx);
-  log_window(ctx);
-  test_window(ctx);
-  mu_end(ctx);
+static int alloc_check_report(const at_Frame* total, int frames)
+{
+  printf("allocations over %d frames after %d warm-up frames:\n", frames, ALLOC_CHECK_WARMUP);
+  for (int s = 0; s < AT_SCOPE_MAX; s++) {
+    printf("  %-7s malloc %6lld  new %6lld  bytes %8lld\n", at_scope_name(s),
+      total->count[s][AT_MALLOC], total->count[s][AT_NEW], total->bytes[s]);
+  }
+  long long critical = at_total(total, 1);
+  printf(critical ? "FAIL: %lld allocations in frame code\n" : "PASS\n", critical);
+  return critical ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 static int text_width(mu_Font font, const char* text, int len) {
   if (len == -1) { len = static_cast<int>(strlen(text)); }
+  ps_count_text_width();
   return r_get_text_width(text, len);
 }
 
@@ -249,8 +147,106 @@ static int text_height(mu_Font font) {
   return r_get_text_height();
 }
 
-int main(void)
+/* feeds a command capture through the GL renderer as fast as it goes */
+static int play_capture(GLFWwindow* window, r_Renderer* renderer, const char* path)
 {
+  cap_Reader* reader = cap_reader_open(path);
+  if (!reader) { return EXIT_FAILURE; }
+  glfwSwapInterval(0);
+  int frames = cap_reader_frame_count(reader);
+  double start = glfwGetTime();
+  for (int i = 0; i < frames && !glfwWindowShouldClose(window); i++) {
+    const char* data;
+    int size;
+    mu_Color clear;
+    cap_reader_frame(reader, i, &data, &size, &clear);
+    r_clear(renderer, clear);
+    r_draw_command_list(renderer, data, size);
+    r_present(renderer);
+    glfwSwapBuffers(window);
+    glfwPollEvents();
+  }
+  double elapsed = glfwGetTime() - start;
+  printf("replayed %d frames in %.3f s: %.3f ms/frame, %.1f fps\n",
+    frames, elapsed, frames ? elapsed * 1000.0 / frames : 0.0, frames ? frames / elapsed : 0.0);
+  cap_reader_close(reader);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  int workers = 0;
+  bool pipelined = false;
+  bool latency = false;
+  int vsync = 1;
+  int probe = 0;
+  bool late_latch = false;
+  const char* record = NULL;
+  const char* capture = NULL;
+  const char* play = NULL;
+  const char* trace = NULL;
+  int alloc_check = 0;
+  int windows = 1;
+  int viewport_bench = 0;
+  int build_threads = 1;
+  bool cull = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--workers" && i + 1 < argc) {
+      // translate large command lists on N threads
+      workers = atoi(argv[++i]);
+    } else if (arg == "--pipeline") {
+      // build the next frame while a render thread presents the current one
+      pipelined = true;
+    } else if (arg == "--latency") {
+      latency = true;
+    } else if (arg == "--vsync" && i + 1 < argc) {
+      vsync = atoi(argv[++i]);
+    } else if (arg == "--probe" && i + 1 < argc) {
+      // inject synthetic input, report input-to-present percentiles and quit
+      probe = atoi(argv[++i]);
+    } else if (arg == "--late-latch") {
+      // sleep until just before vblank, then poll input and build
+      late_latch = true;
+    } else if (arg == "--record" && i + 1 < argc) {
+      // log every mu_input_* call for headless replay
+      record = argv[++i];
+    } else if (arg == "--capture" && i + 1 < argc) {
+      // stream every frame's command list to a file
+      capture = argv[++i];
+    } else if (arg == "--play-capture" && i + 1 < argc) {
+      // render a capture at full speed instead of running the UI
+      play = argv[++i];
+    } else if (arg == "--stats") {
+      // show the per-frame counters window
+      ps_set_window(1);
+    } else if (arg == "--trace" && i + 1 < argc) {
+      // record profiling zones; F9 and exit write them to FILE
+      trace = argv[++i];
+    } else if (arg == "--alloc-check" && i + 1 < argc) {
+      // drive the demo with scripted input and fail if steady-state frames allocate
+      alloc_check = atoi(argv[++i]);
+    } else if (arg == "--windows" && i + 1 < argc) {
+      // open N windows sharing one atlas and program, each with its own UI
+      windows = atoi(argv[++i]);
+    } else if (arg == "--viewport-bench" && i + 1 < argc) {
+      // print startup, frame time and memory for 1..N shared windows and exit
+      viewport_bench = atoi(argv[++i]);
+    } else if (arg == "--build-threads" && i + 1 < argc) {
+      // with --windows, build the windows' UIs on N threads
+      build_threads = atoi(argv[++i]);
+    } else if (arg == "--cull") {
+      // drop commands hidden under opaque windows before rendering
+      cull = true;
+    }
+  }
+#ifndef MU_ALLOC_TRACK
+  if (alloc_check > 0) {
+    fprintf(stderr, "--alloc-check needs a build with MU_ALLOC_TRACK defined\n");
+    exit(EXIT_FAILURE);
+  }
+#endif
+
   glfwSetErrorCallback(error_callback);
 
   if (!glfwInit()) {
@@ -263,6 +259,12 @@ int main(void)
   // glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
   // glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+  if (viewport_bench > 0 || windows > 1) {
+    int res = viewport_bench > 0 ? vp_bench(viewport_bench, 300) : vp_run(windows, vsync, build_threads);
+    glfwTerminate();
+    exit(res);
+  }
+
   GLFWwindow* window = glfwCreateWindow(800, 600, "microui-sample", NULL, NULL);
   if (!window)
   {
@@ -270,117 +272,146 @@ int main(void)
     exit(EXIT_FAILURE);
   }
 
+  input_queue = iq_create();
   glfwSetKeyCallback(window, key_callback);
   glfwSetCharCallback(window, character_callback);
   glfwSetScrollCallback(window, scroll_callback);
+  glfwSetCursorPosCallback(window, cursor_position_callback);
+  glfwSetMouseButtonCallback(window, mouse_button_callback);
 
   glfwMakeContextCurrent(window);
   gladLoadGL(); // gladLoadGL(glfwGetProcAddress) if glad generated without a loader
-  glfwSwapInterval(1);
+  glfwSwapInterval(vsync);
 
   //glClearColor(0.0, 0.0, 0.0, 1.0);
-  r_init();
+  r_Shared* shared = r_shared_create();
+  r_Renderer* renderer = r_create(shared, 800, 600);
+  r_set_workers(workers);
   /* init microui */
-  mu_Context* ctx = reinterpret_cast<mu_Context*>(malloc(sizeof(mu_Context)));
+  mu_Context* ctx = new mu_Context;
   mu_init(ctx);
   ctx->text_width = text_width;
   ctx->text_height = text_height;
 
-  double prv_xpos = 0.0, prv_ypos = 0.0;
-  uint32_t prv_mousedown = 0, prv_mouseup = 0;
-  uint32_t prv_keydown = 0, prv_keyup = 0;
+  if (play) {
+    int res = play_capture(window, renderer, play);
+    r_set_workers(0);
+    r_destroy(renderer);
+    r_shared_destroy(shared);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    exit(res);
+  }
+
+  if (pipelined && late_latch) {
+    fprintf(stderr, "--late-latch is ignored with --pipeline\n");
+    late_latch = false;
+  }
+  if (late_latch) {
+    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    fp_init(mode ? mode->refreshRate : 60.0);
+  }
+  if (pipelined) { pl_start(window, renderer, latency); }
+  if (probe > 0) { lat_probe_begin(probe, 60); }
+  if (record && !ir_record_open(record)) { exit(EXIT_FAILURE); }
+  if (capture && !cap_open(capture)) { exit(EXIT_FAILURE); }
+  if (trace) {
+#ifndef MU_TRACE
+    fprintf(stderr, "--trace needs a build with MU_TRACE defined\n");
+#endif
+    trace_set_enabled(1);
+  }
+  at_Frame alloc_total = {};
+  int frame = 0;
+
   while (!glfwWindowShouldClose(window))
   {
-    glfwPollEvents();
+    if (late_latch) { fp_wait(); }
+    if (trace && trace_dump_requested) {
+      trace_dump(trace);
+      trace_dump_requested = false;
+    }
+    if (probe > 0) {
+      if (lat_probe_done()) { break; }
+      inject_probe_event();
+    }
+    if (alloc_check > 0) {
+      if (frame == ALLOC_CHECK_WARMUP + alloc_check) { break; }
+      inject_sweep_event(frame);
+    }
+    double input_time;
+    {
+      ALLOC_SCOPE(AT_INPUT);
+      glfwPollEvents();
+      input_time = glfwGetTime();
+
+      /* feed buffered input in arrival order */
+      iq_drain(input_queue, ctx);
+      ir_record_frame();
+    }
+    double probe_time = iq_take_probe_time(input_queue);
 
+    /* process frame */
+    double build_start = glfwGetTime();
     {
-      // mouse
-      double xpos, ypos;
-      glfwGetCursorPos(window, &xpos, &ypos);
-      prv_xpos = xpos;
-      prv_ypos = ypos;
-      uint32_t mousedown = 0, mouseup = 0;
-      constexpr std::pair<int, int> tbl[] = {
-        {GLFW_MOUSE_BUTTON_LEFT, MU_MOUSE_LEFT},
-        {GLFW_MOUSE_BUTTON_MIDDLE, MU_MOUSE_MIDDLE},
-        {GLFW_MOUSE_BUTTON_RIGHT, MU_MOUSE_RIGHT},
-      };
-      for (const auto& p : tbl) {
-        auto b = glfwGetMouseButton(window, p.first);
-        if (b == GLFW_PRESS) {
-          mousedown |= p.second;
-        } else if (b == GLFW_RELEASE) {
-          mouseup |= p.second;
-        }
-      }
-      auto trig_mousedown = ~prv_mousedown & mousedown;
-      auto trig_mouseup = ~prv_mouseup & mouseup;
-      mu_input_mousedown(ctx, static_cast<int>(xpos), static_cast<int>(ypos), trig_mousedown);
-      mu_input_mouseup(ctx, static_cast<int>(xpos), static_cast<int>(ypos), trig_mouseup);
-      prv_mousedown = mousedown;
-      prv_mouseup = mouseup;
-      // wheel
-      if (mouse_wheel != 0.0) {
-        mu_input_scroll(ctx, 0, static_cast<int>(mouse_wheel * -30));
+      ALLOC_SCOPE(AT_UI);
+      process_frame(ctx);
+      if (cull) {
+        oc_Stats culled = oc_cull(ctx);
+        ps_set_culled(culled.commands, culled.quads);
       }
-      mouse_wheel = 0.0;
-      // text
-      if (character_codepoint) {
-        char text[16] = {};
-        memcpy(text, &character_codepoint, sizeof(character_codepoint));
-        mu_input_text(ctx, text);
-        character_codepoint = 0;
-      }
-      // key
-      {
-        uint32_t keydown = 0, keyup = 0;
-        constexpr std::pair<int, int> keytbl[] = {
-          {GLFW_KEY_LEFT_SHIFT, MU_KEY_SHIFT},
-          {GLFW_KEY_RIGHT_SHIFT, MU_KEY_SHIFT},
-          {GLFW_KEY_LEFT_CONTROL, MU_KEY_CTRL},
-          {GLFW_KEY_RIGHT_CONTROL, MU_KEY_CTRL},
-          {GLFW_KEY_LEFT_ALT, MU_KEY_ALT},
-          {GLFW_KEY_RIGHT_ALT, MU_KEY_ALT},
-          {GLFW_KEY_ENTER, MU_KEY_RETURN},
-          {GLFW_KEY_BACKSPACE, MU_KEY_BACKSPACE},
-        };
-        for (const auto& p : keytbl) {
-          int state = glfwGetKey(window, p.first);
-          if (state == GLFW_PRESS) { keydown |= p.second; }
-          else if (state == GLFW_RELEASE) { keyup |= p.second; }
-        }
-        auto trig_keydown = ~prv_keydown & keydown;
-        auto trig_keyup = ~prv_keyup & keyup;
-        mu_input_keydown(ctx, trig_keydown);
-        mu_input_keyup(ctx, trig_keyup);
-        prv_keydown = keydown;
-        prv_keyup = keyup;
+    }
+    ps_set_build_time((glfwGetTime() - build_start) * 1000.0);
+    ps_end_frame(ctx);
+    if (frame++ >= ALLOC_CHECK_WARMUP) {
+      const at_Frame& a = ps_last()->allocs;
+      for (int s = 0; s < AT_SCOPE_MAX; s++) {
+        for (int k = 0; k < AT_KIND_MAX; k++) { alloc_total.count[s][k] += a.count[s][k]; }
+        alloc_total.bytes[s] += a.bytes[s];
       }
     }
 
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    /* process frame */
-    process_frame(ctx);
-
     /* render */
-    r_clear(mu_color(static_cast<int>(bg[0]), static_cast<int>(bg[1]), static_cast<int>(bg[2]), 255));
-    mu_Command* cmd = NULL;
-    while (mu_next_command(ctx, &cmd)) {
-      switch (cmd->type) {
-      case MU_COMMAND_TEXT: r_draw_text(cmd->text.str, cmd->text.pos, cmd->text.color); break;
-      case MU_COMMAND_RECT: r_draw_rect(cmd->rect.rect, cmd->rect.color); break;
-      case MU_COMMAND_ICON: r_draw_icon(cmd->icon.id, cmd->icon.rect, cmd->icon.color); break;
-      case MU_COMMAND_CLIP: r_set_clip_rect(cmd->clip.rect); break;
-      }
+    mu_Color clear = demo_background();
+    cap_frame(ctx, clear);
+    if (pipelined) {
+      pl_submit(ctx, clear, input_time, probe_time);
+      continue;
     }
+    double render_time = glfwGetTime();
+    r_clear(renderer, clear);
+    r_draw_commands(renderer, ctx);
 
-    r_present();
-    glfwSwapBuffers(window);
+    r_present(renderer);
+    double submit_time = glfwGetTime();
+    {
+      ALLOC_SCOPE(AT_GL);
+      glfwSwapBuffers(window);
+    }
+    double present_time = glfwGetTime();
+    if (late_latch) { fp_frame(input_time, render_time, submit_time, present_time); }
+    if (latency) { lat_frame(input_time, render_time, present_time); }
+    if (probe_time >= 0.0) { lat_probe_sample(probe_time, present_time); }
   }
 
+  if (pipelined) { pl_stop(); }
+  ir_record_close();
+  cap_close();
+  if (trace) { trace_dump(trace); }
+  if (probe > 0) {
+    char config[64];
+    snprintf(config, sizeof(config), "vsync=%d pipeline=%d workers=%d", vsync, pipelined ? 1 : 0, workers);
+    lat_probe_report(config);
+  }
+  int result = EXIT_SUCCESS;
+  if (alloc_check > 0) { result = alloc_check_report(&alloc_total, mu_max(frame - ALLOC_CHECK_WARMUP, 0)); }
+  r_set_workers(0);
+  r_destroy(renderer);
+  r_shared_destroy(shared);
+  delete ctx;
   glfwDestroyWindow(window);
+  iq_destroy(input_queue);
 
   glfwTerminate();
-  exit(EXIT_SUCCESS);
+  exit(result);
 }
\ No newline at end of file
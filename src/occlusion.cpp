@@ -0,0 +1,171 @@
+#include <cstddef>
+#include "batch.h"
+#include "occlusion.h"
+#include "trace.h"
+
+/* every command type is large enough to be rewritten as a jump */
+static_assert(sizeof(mu_ClipCommand) >= sizeof(mu_JumpCommand), "clip command too small");
+static_assert(sizeof(mu_RectCommand) >= sizeof(mu_JumpCommand), "rect command too small");
+static_assert(sizeof(mu_TextCommand) >= sizeof(mu_JumpCommand), "text command too small");
+static_assert(sizeof(mu_IconCommand) >= sizeof(mu_JumpCommand), "icon command too small");
+static_assert(sizeof(mu_BoxCommand) >= sizeof(mu_JumpCommand), "box command too small");
+static_assert(sizeof(mu_FrameCommand) >= sizeof(mu_JumpCommand), "frame command too small");
+
+
+static void drop(mu_Command* cmd, int quads, oc_Stats* stats) {
+  cmd->type = MU_COMMAND_JUMP;
+  cmd->jump.dst = reinterpret_cast<char*>(cmd) + cmd->base.size;
+  stats->commands++;
+  stats->quads += quads;
+}
+
+
+static bool contains(mu_Rect outer, mu_Rect r) {
+  return r.x >= outer.x && r.y >= outer.y &&
+    r.x + r.w <= outer.x + outer.w && r.y + r.h <= outer.y + outer.h;
+}
+
+
+static bool overlaps(mu_Rect a, mu_Rect b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+
+static bool same_rect(mu_Rect a, mu_Rect b) {
+  return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+
+static bool hidden(const mu_Rect* occluders, int count, mu_Rect r) {
+  for (int i = 0; i < count; i++) {
+    if (contains(occluders[i], r)) { return true; }
+  }
+  return false;
+}
+
+
+/* the quads a drawing command would emit if it is hidden, else -1 */
+static int hidden_quads(mu_Context* ctx, const mu_Command* cmd, const mu_Rect* occluders, int count) {
+  switch (cmd->type) {
+  case MU_COMMAND_RECT: return hidden(occluders, count, cmd->rect.rect) ? 1 : -1;
+  case MU_COMMAND_ICON: return hidden(occluders, count, cmd->icon.rect) ? 1 : -1;
+  case MU_COMMAND_BOX: return hidden(occluders, count, cmd->box.rect) ? batch_command_quads(cmd) : -1;
+  case MU_COMMAND_FRAME: {
+    /* the border lies just outside the fill */
+    mu_Rect r = cmd->frame.rect;
+    r = mu_rect(r.x - 1, r.y - 1, r.w + 2, r.h + 2);
+    return hidden(occluders, count, r) ? batch_command_quads(cmd) : -1;
+  }
+  case MU_COMMAND_TEXT: {
+    /* only measure text that starts under an occluder */
+    mu_Rect r = mu_rect(cmd->text.pos.x, cmd->text.pos.y, 0, ctx->text_height(cmd->text.font));
+    if (!hidden(occluders, count, r)) { return -1; }
+    r.w = ctx->text_width(cmd->text.font, cmd->text.str, -1);
+    return hidden(occluders, count, r) ? batch_command_quads(cmd) : -1;
+  }
+  }
+  return -1;
+}
+
+
+/* the fill draw_frame() gives a framed window's rect before anything else,
+** as a rect or, with a border, as a frame command, if it is opaque. a
+** frameless window's first command may be a title bar or a control, which
+** says nothing about the rest of the body */
+static bool window_background(const mu_Container* cnt, const mu_Command* first, mu_Rect* background) {
+  if (cnt->opt & MU_OPT_NOFRAME) { return false; }
+  mu_Rect r;
+  if (first->type == MU_COMMAND_RECT && first->rect.color.a == 255) {
+    r = first->rect.rect;
+  } else if (first->type == MU_COMMAND_FRAME && first->frame.color.a == 255) {
+    r = first->frame.rect;
+  } else {
+    return false;
+  }
+  if (!same_rect(r, cnt->rect)) { return false; }
+  *background = r;
+  return true;
+}
+
+
+/* a window hidden as a whole: everything it draws is clipped to its rect,
+** the border aside, so the commands need no tests of their own */
+static void drop_body(char* p, char* end, oc_Stats* stats) {
+  while (p < end) {
+    mu_Command* cmd = reinterpret_cast<mu_Command*>(p);
+    if (cmd->type == MU_COMMAND_JUMP) {
+      p = static_cast<char*>(cmd->jump.dst);
+      continue;
+    }
+    p += cmd->base.size;
+    drop(cmd, batch_command_quads(cmd), stats);
+  }
+}
+
+
+/* one root's body; nested roots are jumped over and culled on their own */
+static void cull_body(mu_Context* ctx, char* p, char* end, const mu_Rect* occluders, int count, oc_Stats* stats) {
+  /* a clip nothing has been drawn under yet, and the clip in effect since
+  ** the last one kept in this body */
+  mu_Command* pending = NULL;
+  mu_Rect clip = { 0, 0, 0, 0 };
+  bool clip_known = false;
+  while (p < end) {
+    mu_Command* cmd = reinterpret_cast<mu_Command*>(p);
+    if (cmd->type == MU_COMMAND_JUMP) {
+      p = static_cast<char*>(cmd->jump.dst);
+      continue;
+    }
+    p += cmd->base.size;
+    if (cmd->type == MU_COMMAND_CLIP) {
+      /* a clip replaced before anything was drawn has no effect, and
+      ** neither has one that sets the clip already in effect */
+      if (pending) { drop(pending, 0, stats); }
+      pending = cmd;
+      if (clip_known && same_rect(cmd->clip.rect, clip)) {
+        drop(cmd, 0, stats);
+        pending = NULL;
+      }
+      continue;
+    }
+    int quads = hidden_quads(ctx, cmd, occluders, count);
+    if (quads >= 0) {
+      drop(cmd, quads, stats);
+    } else if (pending) {
+      clip = pending->clip.rect;
+      clip_known = true;
+      pending = NULL;
+    }
+  }
+}
+
+
+oc_Stats oc_cull(mu_Context* ctx) {
+  TRACE_ZONE("occlusion cull");
+  oc_Stats stats = { 0, 0 };
+  /* window backgrounds seen so far, i.e. in front of the current root */
+  mu_Rect occluders[MU_CONTAINERPOOL_SIZE];
+  mu_Rect candidates[MU_CONTAINERPOOL_SIZE];
+  int count = 0;
+  for (mu_Container* cnt = ctx->z_order.front; cnt; cnt = cnt->z.prev) {
+    if (cnt->root_frame != ctx->frame) { continue; }
+    char* body = reinterpret_cast<char*>(cnt->head) + cnt->head->base.size;
+    char* end = reinterpret_cast<char*>(cnt->tail);
+
+    const mu_Command* first = reinterpret_cast<const mu_Command*>(body);
+    mu_Rect background = mu_rect(0, 0, 0, 0);
+    bool opaque = body < end && window_background(cnt, first, &background);
+
+    /* any subset of the occluders is safe; with a background, keep those
+    ** that overlap it or its border */
+    int n = 0;
+    mu_Rect extent = mu_rect(background.x - 1, background.y - 1, background.w + 2, background.h + 2);
+    for (int i = 0; i < count; i++) {
+      if (!opaque || overlaps(occluders[i], extent)) { candidates[n++] = occluders[i]; }
+    }
+    if (opaque && hidden(candidates, n, extent)) { drop_body(body, end, &stats); }
+    else if (n > 0) { cull_body(ctx, body, end, candidates, n, &stats); }
+    if (opaque && count < MU_CONTAINERPOOL_SIZE) { occluders[count++] = background; }
+  }
+  return stats;
+}
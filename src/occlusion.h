@@ -0,0 +1,20 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+extern "C" {
+#include "microui.h"
+}
+
+/* what oc_cull() dropped from a frame */
+typedef struct {
+  int commands;
+  int quads;  /* as batch_command_quads() counts them */
+} oc_Stats;
+
+/* optional pass after mu_end(): walks the frame's root containers front to
+** back and drops every command that lies entirely under the opaque
+** background of a window in front of it, and clip commands left with
+** nothing to clip. a dropped command becomes a jump over itself, so
+** mu_next_command() and everything built on it never see it */
+oc_Stats oc_cull(mu_Context* ctx);
+
+#endif
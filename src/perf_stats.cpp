@@ -0,0 +1,257 @@
+#include <atomic>
+#include <cstring>
+#include <stdio.h>
+#include "perf_stats.h"
+
+/* the renderer may run on its own thread, so its counters are atomic; the
+** UI-thread counters are plain */
+static std::atomic<int> flushes, quads, draw_calls, clip_changes, text_width_calls;
+static std::atomic<long long> bytes_uploaded;
+static std::atomic<double> render_ms, gpu_ms{ -1.0 }, gpu_batch_max_ms;
+static std::atomic<int> gpu_batches;
+static double build_ms;
+static int culled_commands, culled_quads;
+
+static ps_Stats history[PS_HISTORY];
+static int recorded;
+static ps_Stats current;
+static int show_window;
+
+/* last frame's pool ids, per context */
+struct PoolHistory {
+  const mu_Context* ctx;
+  mu_Id containers[MU_CONTAINERPOOL_SIZE];
+  mu_Id treenodes[MU_TREENODEPOOL_SIZE];
+};
+static PoolHistory pools[PS_MAX_CONTEXTS];
+
+
+/* slots touched this frame either kept their id (a hit) or were taken over
+** from an older one (an eviction) */
+static void scan_pool(mu_Context* ctx, const mu_PoolItem* items, mu_Id* prev, int len, ps_Stats* s) {
+  for (int i = 0; i < len; i++) {
+    if (items[i].last_update == ctx->frame) {
+      if (items[i].id == prev[i]) { s->pool_hits++; }
+      else if (prev[i] != 0) { s->pool_evictions++; }
+    }
+    prev[i] = items[i].id;
+  }
+}
+
+
+static PoolHistory* pool_history(const mu_Context* ctx) {
+  for (PoolHistory& h : pools) {
+    if (h.ctx == ctx) { return &h; }
+  }
+  for (PoolHistory& h : pools) {
+    if (!h.ctx) {
+      h.ctx = ctx;
+      return &h;
+    }
+  }
+  return NULL;
+}
+
+
+void ps_add_context(mu_Context* ctx) {
+  ps_Stats* s = &current;
+
+  /* walk the raw list rather than mu_next_command() so jumps are counted */
+  char* p = ctx->command_list.items;
+  char* end = p + ctx->command_list.idx;
+  while (p < end) {
+    mu_Command* cmd = reinterpret_cast<mu_Command*>(p);
+    if (cmd->type > 0 && cmd->type < MU_COMMAND_MAX) { s->commands[cmd->type]++; }
+    p += cmd->base.size;
+  }
+  s->command_bytes += ctx->command_list.idx;
+
+  PoolHistory* h = pool_history(ctx);
+  if (h) {
+    scan_pool(ctx, ctx->container_pool, h->containers, MU_CONTAINERPOOL_SIZE, s);
+    scan_pool(ctx, ctx->treenode_pool, h->treenodes, MU_TREENODEPOOL_SIZE, s);
+  }
+}
+
+
+void ps_end_frame(mu_Context* ctx) {
+  ps_add_context(ctx);
+  ps_Stats* s = &history[recorded % PS_HISTORY];
+  *s = current;
+  memset(&current, 0, sizeof(current));
+  s->frame = ctx->frame;
+
+  s->text_width_calls = text_width_calls.exchange(0, std::memory_order_relaxed);
+  s->flushes = flushes.exchange(0, std::memory_order_relaxed);
+  s->quads = quads.exchange(0, std::memory_order_relaxed);
+  s->draw_calls = draw_calls.exchange(0, std::memory_order_relaxed);
+  s->clip_changes = clip_changes.exchange(0, std::memory_order_relaxed);
+  s->bytes_uploaded = bytes_uploaded.exchange(0, std::memory_order_relaxed);
+  s->culled_commands = culled_commands;
+  s->culled_quads = culled_quads;
+  s->cpu_build_ms = build_ms;
+  s->cpu_render_ms = render_ms.load(std::memory_order_relaxed);
+  s->gpu_ms = gpu_ms.load(std::memory_order_relaxed);
+  s->gpu_batch_max_ms = gpu_batch_max_ms.load(std::memory_order_relaxed);
+  s->gpu_batches = gpu_batches.load(std::memory_order_relaxed);
+  at_frame(&s->allocs);
+  recorded++;
+}
+
+
+const ps_Stats* ps_last(void) {
+  return ps_history(0);
+}
+
+
+const ps_Stats* ps_history(int age) {
+  if (age < 0 || age >= PS_HISTORY || age >= recorded) { return NULL; }
+  return &history[(recorded - 1 - age) % PS_HISTORY];
+}
+
+
+void ps_count_flush(int n) {
+  flushes.fetch_add(1, std::memory_order_relaxed);
+  quads.fetch_add(n, std::memory_order_relaxed);
+}
+
+
+void ps_count_draw(long long bytes) {
+  draw_calls.fetch_add(1, std::memory_order_relaxed);
+  bytes_uploaded.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+void ps_count_clip(void) {
+  clip_changes.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void ps_count_text_width(void) {
+  text_width_calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void ps_set_build_time(double ms) {
+  build_ms = ms;
+}
+
+
+void ps_set_culled(int commands, int quads) {
+  culled_commands = commands;
+  culled_quads = quads;
+}
+
+
+void ps_set_render_time(double ms) {
+  render_ms.store(ms, std::memory_order_relaxed);
+}
+
+
+void ps_set_gpu_time(double frame_ms, double batch_max_ms, int batches) {
+  gpu_ms.store(frame_ms, std::memory_order_relaxed);
+  gpu_batch_max_ms.store(batch_max_ms, std::memory_order_relaxed);
+  gpu_batches.store(batches, std::memory_order_relaxed);
+}
+
+
+void ps_set_window(int enabled) {
+  show_window = enabled;
+}
+
+
+static int total_commands(const ps_Stats* s) {
+  int n = 0;
+  for (int i = 1; i < MU_COMMAND_MAX; i++) { n += s->commands[i]; }
+  return n;
+}
+
+
+static int quad_count(const ps_Stats* s) {
+  return s->quads;
+}
+
+
+static int cpu_us(const ps_Stats* s) {
+  return static_cast<int>((s->cpu_build_ms + s->cpu_render_ms) * 1000.0);
+}
+
+
+static int gpu_us(const ps_Stats* s) {
+  return static_cast<int>(mu_max(s->gpu_ms, 0.0) * 1000.0);
+}
+
+
+/* one bar per recorded frame, newest on the right, scaled to the maximum */
+static void sparkline(mu_Context* ctx, const char* label, int (*value)(const ps_Stats*)) {
+  int max = 1;
+  for (int i = 0; ps_history(i); i++) { max = mu_max(max, value(ps_history(i))); }
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%s (max %d)", label, max);
+  const int full[] = { -1 };
+  mu_layout_row(ctx, 1, full, 0);
+  mu_label(ctx, buf);
+  mu_layout_row(ctx, 1, full, 40);
+  mu_Rect r = mu_layout_next(ctx);
+  mu_draw_rect(ctx, r, ctx->style->colors[MU_COLOR_BASE]);
+  mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
+  int bar = mu_max(r.w / PS_HISTORY, 1);
+  for (int i = 0; i < PS_HISTORY && ps_history(i); i++) {
+    int x = r.x + r.w - (i + 1) * bar;
+    if (x < r.x) { break; }
+    int h = static_cast<int>(static_cast<long long>(value(ps_history(i))) * r.h / max);
+    mu_draw_rect(ctx, mu_rect(x, r.y + r.h - h, bar, h), color);
+  }
+}
+
+
+void ps_window(mu_Context* ctx) {
+  if (!show_window) { return; }
+  if (mu_begin_window(ctx, "Frame Stats", mu_rect(660, 40, 260, 560))) {
+    const ps_Stats* s = ps_last();
+    if (s) {
+      static const char* names[MU_COMMAND_MAX] = { NULL, "jump", "clip", "rect", "text", "icon", "box", "frame" };
+      const int widths[] = { 140, -1 };
+      mu_layout_row(ctx, 2, widths, 0);
+      char buf[32];
+      for (int i = 1; i < MU_COMMAND_MAX; i++) {
+        snprintf(buf, sizeof(buf), "%s commands:", names[i]);
+        mu_label(ctx, buf);
+        snprintf(buf, sizeof(buf), "%d", s->commands[i]);
+        mu_label(ctx, buf);
+      }
+      const struct { const char* label; long long value; } rows[] = {
+        { "command bytes:",    s->command_bytes    },
+        { "quads:",            s->quads            },
+        { "flushes:",          s->flushes          },
+        { "draw calls:",       s->draw_calls       },
+        { "bytes uploaded:",   s->bytes_uploaded   },
+        { "clip changes:",     s->clip_changes     },
+        { "text_width calls:", s->text_width_calls },
+        { "pool hits:",        s->pool_hits        },
+        { "pool evictions:",   s->pool_evictions   },
+        { "culled commands:",  s->culled_commands  },
+        { "culled quads:",     s->culled_quads     },
+        { "allocations:",      at_total(&s->allocs, 0) },
+      };
+      for (const auto& row : rows) {
+        mu_label(ctx, row.label);
+        snprintf(buf, sizeof(buf), "%lld", row.value);
+        mu_label(ctx, buf);
+      }
+      mu_label(ctx, "cpu build/render ms:");
+      snprintf(buf, sizeof(buf), "%.3f / %.3f", s->cpu_build_ms, s->cpu_render_ms);
+      mu_label(ctx, buf);
+      mu_label(ctx, "gpu ms (slowest):");
+      if (s->gpu_ms < 0.0) { snprintf(buf, sizeof(buf), "n/a"); }
+      else { snprintf(buf, sizeof(buf), "%.3f (%.3f of %d)", s->gpu_ms, s->gpu_batch_max_ms, s->gpu_batches); }
+      mu_label(ctx, buf);
+      sparkline(ctx, "commands", total_commands);
+      sparkline(ctx, "quads", quad_count);
+      sparkline(ctx, "cpu us", cpu_us);
+      if (s->gpu_ms >= 0.0) { sparkline(ctx, "gpu us", gpu_us); }
+    }
+    mu_end_window(ctx);
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+#include "alloc_track.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "microui.h"
+
+/* per-frame performance counters. the UI side is scanned by ps_end_frame()
+** and ps_add_context(); the renderer side is accumulated as it happens and
+** folded into the next ps_end_frame(), so with the render thread those
+** numbers lag a frame. with several contexts, every counter covers all of
+** them: text_width calls, flushes and build time are process-wide, so the
+** other contexts are passed to ps_add_context() */
+typedef struct {
+  int frame;
+  int commands[MU_COMMAND_MAX];  /* indexed by MU_COMMAND_*, jumps included */
+  int command_bytes;
+  int quads;
+  int flushes;
+  int draw_calls;
+  long long bytes_uploaded;
+  int clip_changes;
+  int text_width_calls;
+  int pool_hits;
+  int pool_evictions;
+  int culled_commands;      /* dropped by oc_cull(), when enabled */
+  int culled_quads;
+  double cpu_build_ms;      /* building the UI */
+  double cpu_render_ms;     /* r_clear() to r_present() */
+  double gpu_ms;            /* negative without timer queries */
+  double gpu_batch_max_ms;  /* the slowest timed segment */
+  int gpu_batches;
+  at_Frame allocs;          /* all zero unless built with MU_ALLOC_TRACK */
+} ps_Stats;
+
+#define PS_HISTORY 120
+#define PS_MAX_CONTEXTS 16
+
+/* call after mu_end(); completes the frame */
+void ps_end_frame(mu_Context* ctx);
+/* adds another context's commands and pool hits to the frame in progress;
+** call before ps_end_frame(). pool history is kept for up to
+** PS_MAX_CONTEXTS contexts, those beyond report no pool hits */
+void ps_add_context(mu_Context* ctx);
+/* the last completed frame */
+const ps_Stats* ps_last(void);
+/* the `age`th frame back from the last, 0 <= age < PS_HISTORY; NULL if it
+** has not been recorded yet */
+const ps_Stats* ps_history(int age);
+
+/* counting hooks, all cheap enough to stay on */
+void ps_count_flush(int quads);
+void ps_count_draw(long long bytes);
+void ps_count_clip(void);
+void ps_count_text_width(void);
+void ps_set_build_time(double ms);
+void ps_set_culled(int commands, int quads);
+void ps_set_render_time(double ms);
+/* GPU results arrive a few frames late, see gpu_timer.h */
+void ps_set_gpu_time(double frame_ms, double batch_max_ms, int batches);
+
+/* the "Frame Stats" window with sparklines; does nothing unless enabled */
+void ps_set_window(int enabled);
+void ps_window(mu_Context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
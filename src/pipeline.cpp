@@ -0,0 +1,103 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "pipeline.h"
+#include "alloc_track.h"
+#include "cmdlist.h"
+#include "latency.h"
+#include "renderer.h"
+
+enum { SLOT_FREE, SLOT_READY, SLOT_QUIT };
+
+/* each slot is owned by exactly one thread at a time; `state` is the only
+** thing both threads touch, so there are no locks on the hot path */
+struct FrameSlot {
+  std::atomic<int> state{ SLOT_FREE };
+  std::vector<char> commands = std::vector<char>(MU_COMMANDLIST_SIZE);
+  int size = 0;
+  mu_Color clear = {};
+  double input_time = 0.0;
+  double probe_time = -1.0;
+};
+
+static FrameSlot slots[2];
+static std::thread render_thread;
+static GLFWwindow* target;
+static r_Renderer* renderer;
+static unsigned submitted;
+static int latency;
+
+
+static void wait_until_free(FrameSlot& slot) {
+  int s;
+  while ((s = slot.state.load(std::memory_order_acquire)) != SLOT_FREE) {
+    slot.state.wait(s, std::memory_order_acquire);
+  }
+}
+
+
+static void render_main(void) {
+  glfwMakeContextCurrent(target);
+  for (unsigned n = 0;; n++) {
+    FrameSlot& slot = slots[n & 1];
+    int s;
+    while ((s = slot.state.load(std::memory_order_acquire)) == SLOT_FREE) {
+      slot.state.wait(s, std::memory_order_acquire);
+    }
+    if (s == SLOT_QUIT) { break; }
+
+    double render_time = glfwGetTime();
+    r_clear(renderer, slot.clear);
+    r_draw_command_list(renderer, slot.commands.data(), slot.size);
+    r_present(renderer);
+    {
+      ALLOC_SCOPE(AT_GL);
+      glfwSwapBuffers(target);
+    }
+    double present_time = glfwGetTime();
+    if (latency) { lat_frame(slot.input_time, render_time, present_time); }
+    if (slot.probe_time >= 0.0) { lat_probe_sample(slot.probe_time, present_time); }
+
+    slot.state.store(SLOT_FREE, std::memory_order_release);
+    slot.state.notify_one();
+  }
+  glfwMakeContextCurrent(NULL);
+}
+
+
+void pl_start(GLFWwindow* window, r_Renderer* r, int report_latency) {
+  target = window;
+  renderer = r;
+  latency = report_latency;
+  submitted = 0;
+  glfwMakeContextCurrent(NULL);
+  render_thread = std::thread(render_main);
+}
+
+
+void pl_submit(mu_Context* ctx, mu_Color clear, double input_time, double probe_time) {
+  ALLOC_SCOPE(AT_RENDER);
+  FrameSlot& slot = slots[submitted++ & 1];
+  wait_until_free(slot);
+  slot.size = cmdlist_linearize(ctx, slot.commands.data(), static_cast<int>(slot.commands.size()));
+  slot.clear = clear;
+  slot.input_time = input_time;
+  slot.probe_time = probe_time;
+  slot.state.store(SLOT_READY, std::memory_order_release);
+  slot.state.notify_one();
+}
+
+
+void pl_stop(void) {
+  /* the render thread consumes slots in order, so the next one is where it
+  ** will look for the quit marker */
+  FrameSlot& slot = slots[submitted & 1];
+  wait_until_free(slot);
+  slot.state.store(SLOT_QUIT, std::memory_order_release);
+  slot.state.notify_one();
+  render_thread.join();
+  slot.state.store(SLOT_FREE);
+  glfwMakeContextCurrent(target);
+}
@@ -0,0 +1,20 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+extern "C" {
+#include "microui.h"
+}
+
+struct GLFWwindow;
+typedef struct r_Renderer r_Renderer;
+
+/* pipelined presentation: the UI thread builds frame N+1 while a render
+** thread translates and presents frame N with `r`. the window's GL context
+** moves to the render thread until pl_stop() */
+void pl_start(GLFWwindow* window, r_Renderer* r, int report_latency);
+/* copies a finished frame into the free slot of the double buffer; waits only
+** while the render thread still holds both slots. a non-negative
+** `probe_time` tags the frame for the latency probe */
+void pl_submit(mu_Context* ctx, mu_Color clear, double input_time, double probe_time);
+void pl_stop(void);
+
+#endif
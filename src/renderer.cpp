@@ -1,26 +1,32 @@
+#include <chrono>
 #include <cstring>
 #include <assert.h>
 #include <glad/glad.h>
 #include <linmath.h>
 #include "renderer.h"
-
-#include "atlas.inl"
-
-#define BUFFER_SIZE 16384
-
-static GLfloat   tex_buf[BUFFER_SIZE *  8];
-static GLfloat  vert_buf[BUFFER_SIZE *  8];
-static GLubyte color_buf[BUFFER_SIZE * 16];
-static GLuint  index_buf[BUFFER_SIZE *  6];
-
-static GLuint atlas_tex_id;
-static GLuint vertex_shader, fragment_shader, program;
-static GLint mvp_location;
-static GLuint VAO, VBO[3], EBO;
-
-static int width  = 800;
-static int height = 600;
-static int buf_idx;
+#include "alloc_track.h"
+#include "batch.h"
+#include "gpu_timer.h"
+#include "perf_stats.h"
+#include "trace.h"
+
+struct r_Shared {
+  GLuint atlas_tex_id;
+  GLuint vertex_shader, fragment_shader, program;
+  GLint mvp_location;
+  GLuint EBO;
+  /* the GPU timer's queries live in one context, and the frame stats
+  ** describe one window: the first renderer created gets both */
+  r_Renderer* primary;
+};
+
+struct r_Renderer {
+  Batch batch;
+  r_Shared* shared;
+  GLuint VAO, VBO[3];
+  int width, height;
+  std::chrono::steady_clock::time_point frame_start;
+};
 
 const char* vertex_shader_text = "#version 330 core\n"
 "uniform mat4 MVP;\n"
@@ -48,20 +54,22 @@ const char* fragment_shader_text = "#version 330 core\n"
 "   FragColor = vec4(1.0, 1.0, 1.0, texture(tex0, texCoord).r) * fColor;\n"
 "}\n\0";
 
-void r_init(void) {
-  /* init gl */
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glDisable(GL_CULL_FACE);
-  glDisable(GL_DEPTH_TEST);
-  glEnable(GL_SCISSOR_TEST);
-  assert(glGetError() == 0);
+static void flush(Batch* b);
+static void set_clip(Batch* b, mu_Rect rect);
+
+
+r_Shared* r_shared_create(void) {
+  ALLOC_SCOPE(AT_GL);
+  r_Shared* shared = new r_Shared;
+  shared->primary = NULL;
 
   /* init texture */
-  glGenTextures(1, &atlas_tex_id);
-  glBindTexture(GL_TEXTURE_2D, atlas_tex_id);
+  int atlas_width, atlas_height;
+  const unsigned char* atlas_texture = batch_atlas_texture(&atlas_width, &atlas_height);
+  glGenTextures(1, &shared->atlas_tex_id);
+  glBindTexture(GL_TEXTURE_2D, shared->atlas_tex_id);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, ATLAS_HEIGHT, 0,
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas_width, atlas_height, 0,
     GL_RED, GL_UNSIGNED_BYTE, atlas_texture);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -69,34 +77,85 @@ void r_init(void) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   assert(glGetError() == 0);
 
+  /* the index pattern is the same for every flush, so upload it once for a
+  ** full buffer and draw a prefix of it */
+  glGenBuffers(1, &shared->EBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shared->EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * BATCH_SIZE * 6, batch_indices(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  assert(glGetError() == 0);
+
+  // setup shader
+  shared->vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(shared->vertex_shader, 1, &vertex_shader_text, NULL);
+  glCompileShader(shared->vertex_shader);
+
+  shared->fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(shared->fragment_shader, 1, &fragment_shader_text, NULL);
+  glCompileShader(shared->fragment_shader);
+
+  shared->program = glCreateProgram();
+  glAttachShader(shared->program, shared->vertex_shader);
+  glAttachShader(shared->program, shared->fragment_shader);
+  glLinkProgram(shared->program);
+  assert(glGetError() == 0);
+
+  shared->mvp_location = glGetUniformLocation(shared->program, "MVP");
+  assert(glGetError() == 0);
+  return shared;
+}
+
+
+void r_shared_destroy(r_Shared* shared) {
+  if (!shared) { return; }
+  glDeleteProgram(shared->program);
+  glDeleteShader(shared->vertex_shader);
+  glDeleteShader(shared->fragment_shader);
+  glDeleteBuffers(1, &shared->EBO);
+  glDeleteTextures(1, &shared->atlas_tex_id);
+  delete shared;
+}
+
+
+r_Renderer* r_create(r_Shared* shared, int width, int height) {
+  ALLOC_SCOPE(AT_GL);
+  r_Renderer* r = new r_Renderer;
+  r->shared = shared;
+  r->width = width;
+  r->height = height;
+
+  /* init gl; this is per-context state */
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_SCISSOR_TEST);
+  assert(glGetError() == 0);
+
   // buffer
   {
-    // Create reference containers for the Vartex Array Object, the Vertex Buffer Object, and the Element Buffer Object
-
-    // Generate the VAO, VBO, and EBO with only 1 object each
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(3, VBO);
-    glGenBuffers(1, &EBO);
+    // Generate the VAO and one VBO per attribute; the EBO is shared
+    glGenVertexArrays(1, &r->VAO);
+    glGenBuffers(3, r->VBO);
 
     // Make the VAO the current Vertex Array Object by binding it
-    glBindVertexArray(VAO);
+    glBindVertexArray(r->VAO);
 
-    // Bind the EBO specifying it's a GL_ELEMENT_ARRAY_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    // Bind the EBO specifying it's a GL_ELEMENT_ARRAY_BUFFER; the binding is recorded in the VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shared->EBO);
 
     // Bind the VBO specifying it's a GL_ARRAY_BUFFER
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    // Introduce the vertices into the VBO
+    glBindBuffer(GL_ARRAY_BUFFER, r->VBO[0]);
     // Configure the Vertex Attribute so that OpenGL knows how to read the VBO
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     // Enable the Vertex Attribute so that OpenGL knows to use it
     glEnableVertexAttribArray(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
+    glBindBuffer(GL_ARRAY_BUFFER, r->VBO[1]);
     glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 * sizeof(GLubyte), (void*)0);
     glEnableVertexAttribArray(1);
     // tex coord
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
+    glBindBuffer(GL_ARRAY_BUFFER, r->VBO[2]);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(2);
 
@@ -105,171 +164,140 @@ void r_init(void) {
     glBindVertexArray(0);
     // Bind the EBO to 0 so that we don't accidentally modify it
     // MAKE SURE TO UNBIND IT AFTER UNBINDING THE VAO, as the EBO is linked in the VAO
-    // This does not apply to the VBO because the VBO is already linked to the VAO during glVertexAttribPointer
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     assert(glGetError() == 0);
   }
 
-  // setup shader
-  vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertex_shader, 1, &vertex_shader_text, NULL);
-  glCompileShader(vertex_shader);
-
-  fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragment_shader, 1, &fragment_shader_text, NULL);
-  glCompileShader(fragment_shader);
-
-  program = glCreateProgram();
-  glAttachShader(program, vertex_shader);
-  glAttachShader(program, fragment_shader);
-  glLinkProgram(program);
-  assert(glGetError() == 0);
+  if (!shared->primary) {
+    shared->primary = r;
+    gt_init();
+  }
+  batch_init(&r->batch, flush, set_clip, r);
+  return r;
+}
 
-  mvp_location = glGetUniformLocation(program, "MVP");
-  assert(glGetError() == 0);
+
+void r_destroy(r_Renderer* r) {
+  if (!r) { return; }
+  glDeleteVertexArrays(1, &r->VAO);
+  glDeleteBuffers(3, r->VBO);
+  if (r->shared->primary == r) { r->shared->primary = NULL; }
+  delete r;
 }
 
 
-static void flush(void) {
-  if (buf_idx == 0) { return; }
+void r_set_size(r_Renderer* r, int width, int height) {
+  batch_flush(&r->batch);
+  r->width = width;
+  r->height = height;
+}
+
 
-  const float ratio = width / (float)height;
-  glViewport(0, 0, width, height);
+static void flush(Batch* b) {
+  TRACE_ZONE("flush");
+  ALLOC_SCOPE(AT_GL);
+  r_Renderer* r = static_cast<r_Renderer*>(b->user);
+  const r_Shared* shared = r->shared;
+  glViewport(0, 0, r->width, r->height);
 
   mat4x4 m, p, mvp;
   mat4x4_identity(m);
-  mat4x4_ortho(p, 0.0f, static_cast<float>(width), static_cast<float>(height), 0.f, 1.f, -1.f);
+  mat4x4_ortho(p, 0.0f, static_cast<float>(r->width), static_cast<float>(r->height), 0.f, 1.f, -1.f);
   mat4x4_mul(mvp, p, m);
 
-  glUseProgram(program);
-  glUniformMatrix4fv(mvp_location, 1, GL_FALSE, (const GLfloat*)mvp);
+  glUseProgram(shared->program);
+  glUniformMatrix4fv(shared->mvp_location, 1, GL_FALSE, (const GLfloat*)mvp);
 
-  glBindTexture(GL_TEXTURE_2D, atlas_tex_id);
-  glBindVertexArray(VAO);
+  glBindTexture(GL_TEXTURE_2D, shared->atlas_tex_id);
+  glBindVertexArray(r->VAO);
   // Bind the VBO specifying it's a GL_ARRAY_BUFFER
   // vertex
-  glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * buf_idx * 8, vert_buf, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, r->VBO[0]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * b->count * 8, b->vert, GL_STATIC_DRAW);
   // color
-  glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(GLubyte) * buf_idx * 16, color_buf, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, r->VBO[1]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(GLubyte) * b->count * 16, b->color, GL_STATIC_DRAW);
   // tex coord
-  glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * buf_idx * 8, tex_buf, GL_STATIC_DRAW);
-  // Bind the EBO specifying it's a GL_ELEMENT_ARRAY_BUFFER
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * buf_idx * 6, index_buf, GL_STATIC_DRAW);
-  glDrawElements(GL_TRIANGLES, buf_idx * 6, GL_UNSIGNED_INT, 0);
-
-  buf_idx = 0;
+  glBindBuffer(GL_ARRAY_BUFFER, r->VBO[2]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * b->count * 8, b->tex, GL_STATIC_DRAW);
+  const bool timed = shared->primary == r;
+  if (timed) { gt_begin(); }
+  glDrawElements(GL_TRIANGLES, b->count * 6, GL_UNSIGNED_INT, 0);
+  if (timed) { gt_end(); }
+  ps_count_draw((sizeof(float) * 16 + sizeof(GLubyte) * 16) * static_cast<long long>(b->count));
 }
 
 
-static void push_quad(mu_Rect dst, mu_Rect src, mu_Color color) {
-  if (buf_idx == BUFFER_SIZE) { flush(); }
-
-  int texvert_idx = buf_idx *  8;
-  int   color_idx = buf_idx * 16;
-  int element_idx = buf_idx *  4;
-  int   index_idx = buf_idx *  6;
-  buf_idx++;
-
-  /* update texture buffer */
-  float x = src.x / (float) ATLAS_WIDTH;
-  float y = src.y / (float) ATLAS_HEIGHT;
-  float w = src.w / (float) ATLAS_WIDTH;
-  float h = src.h / (float) ATLAS_HEIGHT;
-  tex_buf[texvert_idx + 0] = x;
-  tex_buf[texvert_idx + 1] = y;
-  tex_buf[texvert_idx + 2] = x + w;
-  tex_buf[texvert_idx + 3] = y;
-  tex_buf[texvert_idx + 4] = x;
-  tex_buf[texvert_idx + 5] = y + h;
-  tex_buf[texvert_idx + 6] = x + w;
-  tex_buf[texvert_idx + 7] = y + h;
-
-  /* update vertex buffer */
-  vert_buf[texvert_idx + 0] = static_cast<GLfloat>(dst.x);
-  vert_buf[texvert_idx + 1] = static_cast<GLfloat>(dst.y);
-  vert_buf[texvert_idx + 2] = static_cast<GLfloat>(dst.x + dst.w);
-  vert_buf[texvert_idx + 3] = static_cast<GLfloat>(dst.y);
-  vert_buf[texvert_idx + 4] = static_cast<GLfloat>(dst.x);
-  vert_buf[texvert_idx + 5] = static_cast<GLfloat>(dst.y + dst.h);
-  vert_buf[texvert_idx + 6] = static_cast<GLfloat>(dst.x + dst.w);
-  vert_buf[texvert_idx + 7] = static_cast<GLfloat>(dst.y + dst.h);
-
-  /* update color buffer */
-  std::memcpy(color_buf + color_idx +  0, &color, 4);
-  std::memcpy(color_buf + color_idx +  4, &color, 4);
-  std::memcpy(color_buf + color_idx +  8, &color, 4);
-  std::memcpy(color_buf + color_idx + 12, &color, 4);
-
-  /* update index buffer */
-  index_buf[index_idx + 0] = element_idx + 0;
-  index_buf[index_idx + 1] = element_idx + 1;
-  index_buf[index_idx + 2] = element_idx + 2;
-  index_buf[index_idx + 3] = element_idx + 2;
-  index_buf[index_idx + 4] = element_idx + 3;
-  index_buf[index_idx + 5] = element_idx + 1;
+static void set_clip(Batch* b, mu_Rect rect) {
+  const r_Renderer* r = static_cast<r_Renderer*>(b->user);
+  glScissor(rect.x, r->height - (rect.y + rect.h), rect.w, rect.h);
 }
 
 
-void r_draw_rect(mu_Rect rect, mu_Color color) {
-  push_quad(rect, atlas[ATLAS_WHITE], color);
+void r_draw_rect(r_Renderer* r, mu_Rect rect, mu_Color color) {
+  batch_draw_rect(&r->batch, rect, color);
 }
 
 
-void r_draw_text(const char *text, mu_Vec2 pos, mu_Color color) {
-  mu_Rect dst = { pos.x, pos.y, 0, 0 };
-  for (const char *p = text; *p; p++) {
-    if ((*p & 0xc0) == 0x80) { continue; }
-    int chr = mu_min((unsigned char) *p, 127);
-    mu_Rect src = atlas[ATLAS_FONT + chr];
-    dst.w = src.w;
-    dst.h = src.h;
-    push_quad(dst, src, color);
-    dst.x += dst.w;
-  }
+void r_draw_text(r_Renderer* r, const char *text, mu_Vec2 pos, mu_Color color) {
+  batch_draw_text(&r->batch, text, pos, color);
 }
 
 
-void r_draw_icon(int id, mu_Rect rect, mu_Color color) {
-  mu_Rect src = atlas[id];
-  int x = rect.x + (rect.w - src.w) / 2;
-  int y = rect.y + (rect.h - src.h) / 2;
-  push_quad(mu_rect(x, y, src.w, src.h), src, color);
+void r_draw_icon(r_Renderer* r, int id, mu_Rect rect, mu_Color color) {
+  batch_draw_icon(&r->batch, id, rect, color);
 }
 
 
 int r_get_text_width(const char *text, int len) {
-  int res = 0;
-  for (const char *p = text; *p && len--; p++) {
-    if ((*p & 0xc0) == 0x80) { continue; }
-    int chr = mu_min((unsigned char) *p, 127);
-    res += atlas[ATLAS_FONT + chr].w;
-  }
-  return res;
+  return batch_text_width(text, len);
 }
 
 
 int r_get_text_height(void) {
-  return 18;
+  return batch_text_height();
 }
 
 
-void r_set_clip_rect(mu_Rect rect) {
-  flush();
-  glScissor(rect.x, height - (rect.y + rect.h), rect.w, rect.h);
+void r_set_clip_rect(r_Renderer* r, mu_Rect rect) {
+  batch_set_clip(&r->batch, rect);
 }
 
 
-void r_clear(mu_Color clr) {
-  flush();
+void r_clear(r_Renderer* r, mu_Color clr) {
+  batch_flush(&r->batch);
+  /* r_clear() .. r_present() bracket a frame for timing */
+  const bool timed = r->shared->primary == r;
+  r->frame_start = std::chrono::steady_clock::now();
+  if (timed) { gt_frame_begin(); }
   glClearColor(static_cast<GLfloat>(clr.r / 255.), static_cast<GLfloat>(clr.g / 255.), static_cast<GLfloat>(clr.b / 255.), static_cast<GLfloat>(clr.a / 255.));
+  ALLOC_SCOPE(AT_GL);
+  if (timed) { gt_begin(); }
   glClear(GL_COLOR_BUFFER_BIT);
+  if (timed) { gt_end(); }
+}
+
+
+void r_present(r_Renderer* r) {
+  batch_flush(&r->batch);
+  if (r->shared->primary != r) { return; }
+  gt_frame_end();
+  ps_set_render_time(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - r->frame_start).count());
+}
+
+
+void r_draw_commands(r_Renderer* r, mu_Context* ctx) {
+  ALLOC_SCOPE(AT_RENDER);
+  batch_draw_commands(&r->batch, ctx);
+}
+
+
+void r_draw_command_list(r_Renderer* r, const char* data, int size) {
+  ALLOC_SCOPE(AT_RENDER);
+  batch_draw_command_list(&r->batch, data, size);
 }
 
 
-void r_present(void) {
-  flush();
+void r_set_workers(int count) {
+  batch_set_workers(count);
 }
@@ -4,15 +4,37 @@ extern "C" {
 #include "microui.h"
 }
 
-void r_init(void);
-void r_draw_rect(mu_Rect rect, mu_Color color);
-void r_draw_text(const char *text, mu_Vec2 pos, mu_Color color);
-void r_draw_icon(int id, mu_Rect rect, mu_Color color);
+/* GL objects every renderer draws with: the atlas texture, the linked
+** program and the index buffer, which never changes. create one with a
+** context current; contexts that share objects with it (the `share`
+** argument of glfwCreateWindow) can use it without uploading anything */
+typedef struct r_Shared r_Shared;
+/* one render target: its own quad buffers, vertex buffers and vertex array
+** (vertex arrays are never shared between contexts) and viewport size. use
+** it only with the context that was current in r_create(). renderers of one
+** r_Shared set the program's uniforms, so they must draw from one thread at
+** a time */
+typedef struct r_Renderer r_Renderer;
+
+r_Shared* r_shared_create(void);
+void r_shared_destroy(r_Shared* shared);
+r_Renderer* r_create(r_Shared* shared, int width, int height);
+void r_destroy(r_Renderer* r);
+void r_set_size(r_Renderer* r, int width, int height);
+
+void r_draw_rect(r_Renderer* r, mu_Rect rect, mu_Color color);
+void r_draw_text(r_Renderer* r, const char *text, mu_Vec2 pos, mu_Color color);
+void r_draw_icon(r_Renderer* r, int id, mu_Rect rect, mu_Color color);
  int r_get_text_width(const char *text, int len);
  int r_get_text_height(void);
-void r_set_clip_rect(mu_Rect rect);
-void r_clear(mu_Color color);
-void r_present(void);
+void r_set_clip_rect(r_Renderer* r, mu_Rect rect);
+void r_clear(r_Renderer* r, mu_Color color);
+void r_present(r_Renderer* r);
+/* translates the whole command list of a finished frame */
+void r_draw_commands(r_Renderer* r, mu_Context* ctx);
+/* same for a list produced by cmdlist_linearize() */
+void r_draw_command_list(r_Renderer* r, const char* data, int size);
+/* number of threads used by r_draw_commands(); 0 or 1 translates serially */
+void r_set_workers(int count);
 
 #endif
-
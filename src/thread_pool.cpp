@@ -0,0 +1,149 @@
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "thread_pool.h"
+
+/* jobs[head..] are pending; the owner pops the back, thieves take the front.
+** the vector keeps its capacity so steady-state runs don't allocate */
+struct tp_Queue {
+  std::mutex lock;
+  std::vector<int> jobs;
+  size_t head = 0;
+
+  bool empty() const { return head == jobs.size(); }
+};
+
+struct tp_Pool {
+  std::vector<std::thread> threads;
+  /* one queue per worker plus one for the calling thread (the last one) */
+  std::vector<tp_Queue> queues;
+  std::mutex lock;
+  std::condition_variable wake, done;
+  tp_JobFunc fn = nullptr;
+  void* user = nullptr;
+  unsigned generation = 0;
+  std::atomic<int> remaining{ 0 };
+  int busy = 0;
+  bool quit = false;
+
+  explicit tp_Pool(int n) : queues(n + 1) {}
+};
+
+
+static bool take_job(tp_Pool* pool, int self, int* job) {
+  tp_Queue& own = pool->queues[self];
+  {
+    std::lock_guard<std::mutex> lk(own.lock);
+    if (!own.empty()) {
+      *job = own.jobs.back();
+      own.jobs.pop_back();
+      return true;
+    }
+  }
+  /* steal from the opposite end of the other queues */
+  const int n = static_cast<int>(pool->queues.size());
+  for (int i = 1; i < n; i++) {
+    tp_Queue& other = pool->queues[(self + i) % n];
+    std::lock_guard<std::mutex> lk(other.lock);
+    if (!other.empty()) {
+      *job = other.jobs[other.head++];
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static void drain(tp_Pool* pool, int self) {
+  int job;
+  while (take_job(pool, self, &job)) {
+    pool->fn(pool->user, job);
+    pool->remaining.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+
+static void worker_main(tp_Pool* pool, int self) {
+  unsigned seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(pool->lock);
+      pool->wake.wait(lk, [&] { return pool->quit || pool->generation != seen; });
+      if (pool->quit) { return; }
+      seen = pool->generation;
+      pool->busy++;
+    }
+    drain(pool, self);
+    {
+      std::lock_guard<std::mutex> lk(pool->lock);
+      pool->busy--;
+    }
+    pool->done.notify_one();
+  }
+}
+
+
+tp_Pool* tp_create(int workers) {
+  if (workers < 0) { workers = 0; }
+  tp_Pool* pool = new tp_Pool(workers);
+  pool->threads.reserve(workers);
+  for (int i = 0; i < workers; i++) {
+    pool->threads.emplace_back(worker_main, pool, i);
+  }
+  return pool;
+}
+
+
+void tp_destroy(tp_Pool* pool) {
+  if (!pool) { return; }
+  {
+    std::lock_guard<std::mutex> lk(pool->lock);
+    pool->quit = true;
+  }
+  pool->wake.notify_all();
+  for (auto& t : pool->threads) { t.join(); }
+  delete pool;
+}
+
+
+int tp_worker_count(const tp_Pool* pool) {
+  return static_cast<int>(pool->threads.size());
+}
+
+
+void tp_run(tp_Pool* pool, int jobs, tp_JobFunc fn, void* user) {
+  if (jobs <= 0) { return; }
+  const int self = static_cast<int>(pool->queues.size()) - 1;
+  if (self == 0 || jobs == 1) {
+    for (int i = 0; i < jobs; i++) { fn(user, i); }
+    return;
+  }
+
+  /* publish the job function before any job becomes visible, then deal the
+  ** jobs round-robin; stealing evens out uneven job costs */
+  const int n = self + 1;
+  {
+    std::lock_guard<std::mutex> lk(pool->lock);
+    pool->fn = fn;
+    pool->user = user;
+    pool->remaining.store(jobs, std::memory_order_release);
+    for (int i = 0; i < jobs; i++) {
+      tp_Queue& q = pool->queues[i % n];
+      std::lock_guard<std::mutex> qlk(q.lock);
+      if (q.empty()) { q.jobs.clear(); q.head = 0; }
+      q.jobs.push_back(i);
+    }
+    pool->generation++;
+  }
+  pool->wake.notify_all();
+
+  drain(pool, self);
+
+  /* wait for stragglers still running a stolen job */
+  std::unique_lock<std::mutex> lk(pool->lock);
+  pool->done.wait(lk, [&] {
+    return pool->remaining.load(std::memory_order_acquire) == 0 && pool->busy == 0;
+  });
+}
@@ -0,0 +1,16 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/* small work-stealing pool: every participant owns a deque of job indices,
+** pops from its own back and steals from the front of the others */
+typedef struct tp_Pool tp_Pool;
+typedef void (*tp_JobFunc)(void* user, int job);
+
+tp_Pool* tp_create(int workers);
+void tp_destroy(tp_Pool* pool);
+ int tp_worker_count(const tp_Pool* pool);
+/* runs fn(user, 0..jobs-1) on the workers and the calling thread, returns
+** once every job has finished */
+void tp_run(tp_Pool* pool, int jobs, tp_JobFunc fn, void* user);
+
+#endif
@@ -0,0 +1,115 @@
+#ifdef MU_TRACE
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include "trace.h"
+
+#define TRACE_MAX_DEPTH 64
+
+struct TraceEvent {
+  const char* name;
+  uint64_t begin, end;
+};
+
+/* single writer (the owning thread); `head` is published with release so a
+** dump sees complete events */
+struct TraceRing {
+  TraceEvent events[TRACE_RING_SIZE];
+  std::atomic<uint64_t> head{ 0 };
+  const char* names[TRACE_MAX_DEPTH];
+  uint64_t starts[TRACE_MAX_DEPTH];
+  int depth = 0;
+  int tid;
+};
+
+extern "C" int mu_trace_enabled;
+int mu_trace_enabled = 0;
+
+/* rings outlive their threads so a dump still sees them */
+static std::mutex rings_lock;
+static std::vector<TraceRing*> rings;
+static thread_local TraceRing* ring;
+
+
+static uint64_t now_ns() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+static TraceRing* this_ring() {
+  if (!ring) {
+    ring = new TraceRing;
+    std::lock_guard<std::mutex> lk(rings_lock);
+    ring->tid = static_cast<int>(rings.size()) + 1;
+    rings.push_back(ring);
+  }
+  return ring;
+}
+
+
+extern "C" void mu_trace_begin(const char* name) {
+  TraceRing* r = this_ring();
+  if (r->depth < TRACE_MAX_DEPTH) {
+    r->names[r->depth] = name;
+    r->starts[r->depth] = now_ns();
+  }
+  r->depth++;
+}
+
+
+extern "C" void mu_trace_end(void) {
+  TraceRing* r = this_ring();
+  /* tracing was switched on inside this zone */
+  if (r->depth == 0) { return; }
+  r->depth--;
+  if (r->depth >= TRACE_MAX_DEPTH) { return; }
+  uint64_t head = r->head.load(std::memory_order_relaxed);
+  r->events[head % TRACE_RING_SIZE] = { r->names[r->depth], r->starts[r->depth], now_ns() };
+  r->head.store(head + 1, std::memory_order_release);
+}
+
+
+void trace_set_enabled(int enabled) {
+  mu_trace_enabled = enabled;
+}
+
+
+int trace_dump(const char* path) {
+  FILE* fp = fopen(path, "w");
+  if (!fp) {
+    fprintf(stderr, "can't open '%s'\n", path);
+    return 0;
+  }
+  std::lock_guard<std::mutex> lk(rings_lock);
+  uint64_t origin = UINT64_MAX;
+  for (TraceRing* r : rings) {
+    uint64_t head = r->head.load(std::memory_order_acquire);
+    uint64_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+    for (uint64_t i = first; i < head; i++) {
+      if (r->events[i % TRACE_RING_SIZE].begin < origin) { origin = r->events[i % TRACE_RING_SIZE].begin; }
+    }
+  }
+
+  fprintf(fp, "{\"traceEvents\":[\n");
+  const char* sep = "";
+  for (TraceRing* r : rings) {
+    fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+      sep, r->tid, r->tid);
+    sep = ",\n";
+    uint64_t head = r->head.load(std::memory_order_acquire);
+    uint64_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+    for (uint64_t i = first; i < head; i++) {
+      const TraceEvent& e = r->events[i % TRACE_RING_SIZE];
+      fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", sep,
+        e.name, r->tid, (e.begin - origin) / 1000.0, (e.end - e.begin) / 1000.0);
+    }
+  }
+  fprintf(fp, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose(fp);
+  return 1;
+}
+#endif
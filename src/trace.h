@@ -0,0 +1,31 @@
+#ifndef TRACE_H
+#define TRACE_H
+extern "C" {
+#include "microui.h"
+}
+
+/* zone tracing, built with MU_TRACE: every thread records completed zones
+** into its own ring buffer (the newest TRACE_RING_SIZE survive), which can
+** be dumped as Chrome trace JSON (chrome://tracing, Perfetto). without
+** MU_TRACE the zones and trace_* calls compile to nothing */
+#define TRACE_RING_SIZE 65536
+
+#ifdef MU_TRACE
+struct TraceZone {
+  int active;
+  explicit TraceZone(const char* name) : active(mu_trace_enabled) { if (active) { mu_trace_begin(name); } }
+  ~TraceZone() { if (active) { mu_trace_end(); } }
+};
+#define TRACE_ZONE(name) TraceZone trace_zone_(name)
+
+/* toggle between frames so zones stay balanced */
+void trace_set_enabled(int enabled);
+/* writes every ring to `path`; exact once the traced threads are idle */
+ int trace_dump(const char* path);
+#else
+#define TRACE_ZONE(name) ((void) 0)
+inline void trace_set_enabled(int enabled) {}
+inline  int trace_dump(const char* path) { return 0; }
+#endif
+
+#endif
@@ -0,0 +1,305 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+#include <glad/glad.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+#include "viewports.h"
+#include "alloc_track.h"
+#include "demo.h"
+#include "input_queue.h"
+#include "perf_stats.h"
+#include "renderer.h"
+#include "thread_pool.h"
+
+#define VP_WIDTH  800
+#define VP_HEIGHT 600
+
+struct Viewport {
+  GLFWwindow* window;
+  mu_Context* ctx;
+  DemoState* demo;
+  r_Renderer* renderer;
+  iq_Queue* input;
+  double cursor_x, cursor_y;
+};
+
+
+static Viewport* viewport_of(GLFWwindow* window) {
+  return static_cast<Viewport*>(glfwGetWindowUserPointer(window));
+}
+
+
+/* input is queued per window and drained into the window's own context
+** before its UI is built, as in the single-window path */
+static void push_event(Viewport* vp, int type, int x, int y, int value) {
+  iq_Event ev = {};
+  ev.type = type;
+  ev.time = glfwGetTime();
+  ev.x = x;
+  ev.y = y;
+  ev.value = value;
+  iq_push(vp->input, &ev);
+}
+
+
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+  if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+  }
+  constexpr std::pair<int, int> keytbl[] = {
+    {GLFW_KEY_LEFT_SHIFT, MU_KEY_SHIFT},
+    {GLFW_KEY_RIGHT_SHIFT, MU_KEY_SHIFT},
+    {GLFW_KEY_LEFT_CONTROL, MU_KEY_CTRL},
+    {GLFW_KEY_RIGHT_CONTROL, MU_KEY_CTRL},
+    {GLFW_KEY_LEFT_ALT, MU_KEY_ALT},
+    {GLFW_KEY_RIGHT_ALT, MU_KEY_ALT},
+    {GLFW_KEY_ENTER, MU_KEY_RETURN},
+    {GLFW_KEY_BACKSPACE, MU_KEY_BACKSPACE},
+  };
+  Viewport* vp = viewport_of(window);
+  for (const auto& p : keytbl) {
+    if (p.first != key) { continue; }
+    push_event(vp, action == GLFW_RELEASE ? IQ_KEYUP : IQ_KEYDOWN, 0, 0, p.second);
+  }
+}
+
+
+static void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
+  Viewport* vp = viewport_of(window);
+  vp->cursor_x = xpos;
+  vp->cursor_y = ypos;
+  push_event(vp, IQ_MOUSEMOVE, static_cast<int>(xpos), static_cast<int>(ypos), 0);
+}
+
+
+static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+  constexpr std::pair<int, int> tbl[] = {
+    {GLFW_MOUSE_BUTTON_LEFT, MU_MOUSE_LEFT},
+    {GLFW_MOUSE_BUTTON_MIDDLE, MU_MOUSE_MIDDLE},
+    {GLFW_MOUSE_BUTTON_RIGHT, MU_MOUSE_RIGHT},
+  };
+  Viewport* vp = viewport_of(window);
+  const int x = static_cast<int>(vp->cursor_x), y = static_cast<int>(vp->cursor_y);
+  for (const auto& p : tbl) {
+    if (p.first != button) { continue; }
+    push_event(vp, action == GLFW_PRESS ? IQ_MOUSEDOWN : IQ_MOUSEUP, x, y, p.second);
+  }
+}
+
+
+static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+  push_event(viewport_of(window), IQ_SCROLL, 0, static_cast<int>(yoffset * -30), 0);
+}
+
+
+static void character_callback(GLFWwindow* window, unsigned int codepoint) {
+  iq_push_codepoint(viewport_of(window)->input, codepoint, glfwGetTime());
+}
+
+
+static int text_width(mu_Font font, const char* text, int len) {
+  if (len == -1) { len = static_cast<int>(strlen(text)); }
+  ps_count_text_width();
+  return r_get_text_width(text, len);
+}
+
+static int text_height(mu_Font font) {
+  return r_get_text_height();
+}
+
+
+/* the first window creates the shared objects, the others share its
+** context. leaves the new window's context current */
+static bool open_viewport(Viewport* vp, int index, r_Shared** shared, GLFWwindow* share) {
+  char title[64];
+  snprintf(title, sizeof(title), "microui-sample %d", index + 1);
+  vp->window = glfwCreateWindow(VP_WIDTH, VP_HEIGHT, title, NULL, share);
+  if (!vp->window) { return false; }
+  glfwSetWindowUserPointer(vp->window, vp);
+  vp->input = iq_create();
+  glfwSetKeyCallback(vp->window, key_callback);
+  glfwSetCharCallback(vp->window, character_callback);
+  glfwSetScrollCallback(vp->window, scroll_callback);
+  glfwSetCursorPosCallback(vp->window, cursor_position_callback);
+  glfwSetMouseButtonCallback(vp->window, mouse_button_callback);
+
+  glfwMakeContextCurrent(vp->window);
+  if (!*shared) {
+    gladLoadGL();
+    *shared = r_shared_create();
+  }
+  vp->renderer = r_create(*shared, VP_WIDTH, VP_HEIGHT);
+  vp->ctx = new mu_Context;
+  mu_init(vp->ctx);
+  vp->ctx->text_width = text_width;
+  vp->ctx->text_height = text_height;
+  vp->demo = new DemoState;
+  demo_init(vp->demo);
+  vp->cursor_x = vp->cursor_y = 0.0;
+  return true;
+}
+
+
+static void close_viewports(std::vector<Viewport>& vps, r_Shared* shared) {
+  /* the shared objects go while a context of the group is still alive */
+  for (int i = static_cast<int>(vps.size()) - 1; i >= 0; i--) {
+    glfwMakeContextCurrent(vps[i].window);
+    r_destroy(vps[i].renderer);
+    if (i == 0) { r_shared_destroy(shared); }
+    glfwMakeContextCurrent(NULL);
+    glfwDestroyWindow(vps[i].window);
+    delete vps[i].ctx;
+    delete vps[i].demo;
+    iq_destroy(vps[i].input);
+  }
+  vps.clear();
+}
+
+
+static bool open_viewports(std::vector<Viewport>& vps, int count, r_Shared** shared) {
+  vps.resize(count);
+  for (int i = 0; i < count; i++) {
+    if (!open_viewport(&vps[i], i, shared, i ? vps[0].window : NULL)) {
+      fprintf(stderr, "can't open window %d\n", i + 1);
+      vps.resize(i);
+      if (i > 0) { close_viewports(vps, *shared); }
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* touches only the viewport's own context and demo state, so viewports can
+** be built concurrently */
+static void build_viewport(void* user, int index) {
+  ALLOC_SCOPE(AT_UI);
+  Viewport& vp = (*static_cast<std::vector<Viewport>*>(user))[index];
+  {
+    ALLOC_SCOPE(AT_INPUT);
+    iq_drain(vp.input, vp.ctx);
+  }
+  demo_frame(vp.ctx, vp.demo);
+}
+
+
+static void draw_viewport(Viewport& vp) {
+  glfwMakeContextCurrent(vp.window);
+  r_clear(vp.renderer, demo_state_background(vp.demo));
+  r_draw_commands(vp.renderer, vp.ctx);
+  r_present(vp.renderer);
+  ALLOC_SCOPE(AT_GL);
+  glfwSwapBuffers(vp.window);
+}
+
+
+static void build_viewports(std::vector<Viewport>& vps, tp_Pool* pool) {
+  const int count = static_cast<int>(vps.size());
+  if (pool) {
+    tp_run(pool, count, build_viewport, &vps);
+    return;
+  }
+  for (int i = 0; i < count; i++) { build_viewport(&vps, i); }
+}
+
+
+int vp_run(int count, int vsync, int threads) {
+  std::vector<Viewport> vps;
+  r_Shared* shared = NULL;
+  if (!open_viewports(vps, count, &shared)) { return EXIT_FAILURE; }
+  /* one vsync wait per frame, not one per window */
+  for (int i = 0; i < count; i++) {
+    glfwMakeContextCurrent(vps[i].window);
+    glfwSwapInterval(i == 0 ? vsync : 0);
+  }
+
+  /* this thread pumps events and presents; the pool only builds UIs */
+  tp_Pool* pool = threads > 1 ? tp_create(threads - 1) : NULL;
+
+  bool quit = false;
+  while (!quit) {
+    glfwPollEvents();
+    for (Viewport& vp : vps) {
+      if (glfwWindowShouldClose(vp.window)) { quit = true; }
+    }
+    double build_start = glfwGetTime();
+    build_viewports(vps, pool);
+    ps_set_build_time((glfwGetTime() - build_start) * 1000.0);
+    for (Viewport& vp : vps) { draw_viewport(vp); }
+    for (int i = 1; i < count; i++) { ps_add_context(vps[i].ctx); }
+    ps_end_frame(vps[0].ctx);
+  }
+  tp_destroy(pool);
+  close_viewports(vps, shared);
+  return EXIT_SUCCESS;
+}
+
+
+/* resident set size, including whatever the GL driver allocated. the table
+** reports it above the starting point while the windows are open */
+static long long resident_bytes(void) {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) { return 0; }
+  return static_cast<long long>(pmc.WorkingSetSize);
+#elif defined(__linux__)
+  long long pages = 0, resident = 0;
+  FILE* fp = fopen("/proc/self/statm", "r");
+  if (!fp) { return 0; }
+  if (fscanf(fp, "%lld %lld", &pages, &resident) != 2) { resident = 0; }
+  fclose(fp);
+  return resident * 4096;
+#else
+  return 0;
+#endif
+}
+
+
+int vp_bench(int max_count, int frames) {
+  printf("%7s %12s %12s %12s %12s %12s\n", "windows", "startup ms", "ms/window", "frame ms", "ms/window", "rss MB");
+  const long long base_rss = resident_bytes();
+  for (int count = 1; count <= max_count; count++) {
+    std::vector<Viewport> vps;
+    r_Shared* shared = NULL;
+    double t0 = glfwGetTime();
+    if (!open_viewports(vps, count, &shared)) { return EXIT_FAILURE; }
+    for (Viewport& vp : vps) {
+      glfwMakeContextCurrent(vp.window);
+      glfwSwapInterval(0);
+    }
+    /* the first frame compiles driver state lazily; count it as startup */
+    build_viewports(vps, NULL);
+    for (Viewport& vp : vps) { draw_viewport(vp); }
+    for (Viewport& vp : vps) {
+      glfwMakeContextCurrent(vp.window);
+      glFinish();
+    }
+    double t1 = glfwGetTime();
+
+    for (int f = 0; f < frames; f++) {
+      glfwPollEvents();
+      build_viewports(vps, NULL);
+      for (Viewport& vp : vps) { draw_viewport(vp); }
+    }
+    for (Viewport& vp : vps) {
+      glfwMakeContextCurrent(vp.window);
+      glFinish();
+    }
+    double t2 = glfwGetTime();
+    const long long rss = resident_bytes() - base_rss;
+    close_viewports(vps, shared);
+
+    const double startup = (t1 - t0) * 1000.0;
+    const double frame = (t2 - t1) * 1000.0 / mu_max(frames, 1);
+    printf("%7d %12.2f %12.2f %12.3f %12.3f %12.1f\n", count, startup, startup / count, frame, frame / count,
+      rss / (1024.0 * 1024.0));
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+#ifndef VIEWPORTS_H
+#define VIEWPORTS_H
+
+/* multi-viewport host: opens `count` GLFW windows whose contexts share one
+** atlas texture, program and index buffer (r_Shared). every window runs the
+** demo in its own mu_Context and renderer, with input routed to the window
+** it came from. only the first window waits for vsync. returns when any
+** window is closed. with `threads` > 1 the UIs are built concurrently on a
+** pool while this thread pumps events and presents. glfwInit() must have
+** been called */
+int vp_run(int count, int vsync, int threads);
+/* per-window cost: for 1..max_count windows, times window + renderer
+** creation and a frame over all of them, and reports the growth of the
+** process's resident memory. prints a table and returns */
+int vp_bench(int max_count, int frames);
+
+#endif